@@ -0,0 +1,9 @@
+TEMPLATE = app
+CONFIG += console c++14 release
+CONFIG -= app_bundle
+CONFIG -= qt
+
+SOURCES += main.cpp
+
+INCLUDEPATH += /usr/include/eigen3/
+INCLUDEPATH += ../../Library/
@@ -0,0 +1,102 @@
+//
+//
+// File - Benchmarks/Allocations/main.cpp:
+//
+//      Checks that steady-state stepping does not allocate.  Every dense method is stepped on a
+//  runtime-sized (epode::Dynamic) diffusion system with an in-place system function; after a few
+//  steps to size the buffers, the heap allocations of the following steps are counted with
+//  Epode/allocation.h and must be zero.  The sparse implicit methods are not checked, as the
+//  factorizations of Eigen::SparseLU allocate.
+//
+//          Allocations
+//
+//  The exit status is non-zero if any method allocated.
+//
+//
+// License:
+//
+//      This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0.
+//  If a copy of the MPL was not distributed with this file, You can obtain one
+//  at http://mozilla.org/MPL/2.0/.
+//
+//
+
+// The allocation counter must be included before any Eigen (or Epode) header
+#define EPODE_COUNT_ALLOCATIONS
+#include <Epode/allocation.h>
+
+#include <iomanip>
+#include <iostream>
+
+#include <Epode/ode.h>
+
+using namespace std;
+
+using State = Eigen::Matrix<double, 1, Eigen::Dynamic>;
+
+struct Settings
+{
+        Eigen::Index size = 50;     // The number of components of the state
+        size_t warmup = 20;         // Steps taken before counting
+        size_t steps = 200;         // Steps counted
+};
+
+// Diffusion on a line with fixed (zero) ends, written into the derivative in place
+void diffusion(double, const State& y, State& dydt) {
+    const auto n = y.size();
+    for(Eigen::Index idx = 0; idx < n; ++idx) {
+        const auto left = (idx == 0) ? 0.0 : y[idx - 1];
+        const auto right = (idx == n - 1) ? 0.0 : y[idx + 1];
+        dydt[idx] = left - 2.0*y[idx] + right;
+    }
+}
+
+// Count the allocations of the steady-state steps of a method, returning true if there were none
+template<typename Integrator>
+bool check(const string& name, Integrator integrator, const Settings& settings) {
+    const State y0 = State::LinSpaced(settings.size, 0.0, 1.0);
+    auto stepper = integrator.stepper(diffusion, 0.0, y0);
+    for(size_t idx = 0; idx < settings.warmup; ++idx) stepper.step();
+
+    epode::util::AllocationCount count;
+    for(size_t idx = 0; idx < settings.steps; ++idx) stepper.step();
+    const auto allocations = count.allocations();
+
+    cout << "    " << left << setw(14) << name << right << setw(6) << allocations << " allocations in "
+         << settings.steps << " steps" << (allocations == 0 ? "" : "  FAILED") << endl;
+    return allocations == 0;
+}
+
+int main() {
+    using namespace epode::integrator;
+    using epode::Dynamic;
+
+    const Settings settings;
+    const auto dv = 0.01;
+    bool passed = true;
+
+    cout << "Steady-state allocations, " << settings.size << " components:" << endl;
+    passed &= check("Euler", Euler<double, Dynamic>(dv), settings);
+    passed &= check("HeunEuler", HeunEuler<double, Dynamic>(dv), settings);
+    passed &= check("RKF12", RKF12<double, Dynamic>(dv), settings);
+    passed &= check("Heuns", Heuns<double, Dynamic>(dv), settings);
+    passed &= check("Midpoint", Midpoint<double, Dynamic>(dv), settings);
+    passed &= check("Ralstons", Ralstons<double, Dynamic>(dv), settings);
+    passed &= check("RKF23", RKF23<double, Dynamic>(dv), settings);
+    passed &= check("RKF34", RKF34<double, Dynamic>(dv), settings);
+    passed &= check("BS32", BS32<double, Dynamic>(dv), settings);
+    passed &= check("RKF45", RKF45<double, Dynamic>(dv), settings);
+    passed &= check("BS45", BS45<double, Dynamic>(dv), settings);
+    passed &= check("DP45", DP45<double, Dynamic>(dv), settings);
+    passed &= check("Butcher5th", Butcher5th<double, Dynamic>(dv), settings);
+    passed &= check("DOP853", DOP853<double, Dynamic>(dv), settings);
+    passed &= check("ABM", ABM<double, Dynamic>(dv), settings);
+    passed &= check("Ros3", Ros3<double, Dynamic>(dv), settings);
+    passed &= check("Rodas3", Rodas3<double, Dynamic>(dv), settings);
+    passed &= check("Rodas4", Rodas4<double, Dynamic>(dv), settings);
+    passed &= check("Radau5", Radau5<double, Dynamic>(dv), settings);
+    passed &= check("BDF", BDF<double, Dynamic>(dv), settings);
+
+    cout << (passed ? "PASSED" : "FAILED") << endl;
+    return passed ? 0 : 1;
+}
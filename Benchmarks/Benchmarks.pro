@@ -0,0 +1,7 @@
+TEMPLATE = subdirs
+
+CONFIG += c++14
+
+SUBDIRS += \
+    Allocations \
+    WorkPrecision
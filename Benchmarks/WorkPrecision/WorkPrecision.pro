@@ -0,0 +1,11 @@
+TEMPLATE = app
+CONFIG += console c++14 release
+CONFIG -= app_bundle
+CONFIG -= qt
+
+SOURCES += main.cpp
+
+HEADERS += problems.h
+
+INCLUDEPATH += /usr/include/eigen3/
+INCLUDEPATH += ../../Library/
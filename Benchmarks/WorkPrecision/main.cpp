@@ -0,0 +1,315 @@
+//
+//
+// File - Benchmarks/WorkPrecision/main.cpp:
+//
+//      Work-precision benchmark of every integrator of epode::integrator on the problems of
+//  problems.h.  The adaptive methods are run over a sweep of tolerances and the fixed step
+//  methods over a sweep of step sizes.  For each run the error of the final state against a
+//  reference solution, the wall time, the function evaluations, the accepted steps and the
+//  rejected steps are recorded.  Runs which exceed the evaluation budget (explicit methods on
+//  the stiff problems) or fail are reported but not plotted, and methods with fewer than two
+//  completed runs are only written to the JSON file.
+//
+//      The results are written as one CSV file per problem and method, which plotCSV.py can draw
+//  as a work-precision diagram from the logarithmic columns,
+//
+//          python Library/plotCSV.py -D results --axes 7 6 'wp_robertson_*.csv'
+//
+//  and as a single JSON file with every run, for comparisons between builds.
+//
+//          WorkPrecision [output directory]
+//
+//
+// License:
+//
+//      This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0.
+//  If a copy of the MPL was not distributed with this file, You can obtain one
+//  at http://mozilla.org/MPL/2.0/.
+//
+//
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <exception>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include <Eigen/Dense>
+#include <Epode/ode.h>
+
+#include "problems.h"
+
+using namespace std;
+using namespace epode::triggers::placeholders;
+
+struct Settings
+{
+        string directory = ".";
+        size_t budget = 200000;     // Function evaluations per run
+        double min_seconds = 0.05;  // Fast runs are repeated for at least this long
+        size_t max_repeats = 100;
+};
+
+// A single run, a point of a work-precision diagram
+struct Point
+{
+        string problem;
+        string method;
+        double precision;   // The tolerance, or the step size of a fixed step method
+        double error;
+        double seconds;     // The fastest of the repeated runs
+        size_t evals;
+        size_t steps;
+        size_t rejected;
+        string status;
+
+        bool completed() const { return (status == "Completed") && isfinite(error); }
+};
+
+const char* statusName(epode::Status status) {
+    switch(status) {
+        case epode::Status::Running: return "Running";
+        case epode::Status::Completed: return "Completed";
+        case epode::Status::Event: return "Event";
+        case epode::Status::TimeLimit: return "TimeLimit";
+        case epode::Status::EvalLimit: return "EvalLimit";
+        case epode::Status::RejectLimit: return "RejectLimit";
+        case epode::Status::StepLimit: return "StepLimit";
+        case epode::Status::Diverged: return "Diverged";
+    }
+    return "Unknown";
+}
+
+// The mixed absolute and relative error of the final state
+template<typename State>
+double error(const State& y, const State& reference) {
+    return (y - reference).template lpNorm<Eigen::Infinity>() /
+            max(1.0, reference.template lpNorm<Eigen::Infinity>());
+}
+
+//
+// Reference solutions: the exact solution if the problem has one, otherwise a very tight
+//  tolerance solution by Radau5 (stiff problems) or DOP853 (non-stiff problems).
+//
+template<typename Problem>
+typename Problem::State referenceSolution(const Problem& problem, true_type) {
+    epode::integrator::Radau5<double, Problem::N> integrator(0.0, epode::Tolerance<double>(problem.atol(1e-13), 1e-13));
+    auto results = integrator(epode::fns(problem.system(), problem.pattern()), problem.v0(), problem.v1(),
+                              problem.y0(), epode::output::every(numeric_limits<size_t>::max()));
+    return results.back().y;
+}
+
+template<typename Problem>
+typename Problem::State referenceSolution(const Problem& problem, false_type) {
+    epode::integrator::DOP853<double, Problem::N> integrator(0.0, epode::Tolerance<double>(problem.atol(1e-14), 1e-14));
+    auto results = integrator(problem.system(), problem.v0(), problem.v1(), problem.y0(),
+                              epode::output::every(numeric_limits<size_t>::max()));
+    return results.back().y;
+}
+
+template<typename Problem>
+auto reference(const Problem& problem, int) -> decltype(problem.exact()) {
+    return problem.exact();
+}
+
+template<typename Problem>
+typename Problem::State reference(const Problem& problem, long) {
+    using stiff_t = integral_constant<bool, Problem::stiff>;
+    return referenceSolution(problem, stiff_t{});
+}
+
+//
+// Integrators for a point of the sweep: adaptive methods estimate their initial step and take
+//  the tolerance as the relative tolerance, with the absolute tolerance of the problem.
+//
+template<typename Integrator, typename Problem>
+Integrator makeIntegrator(const Problem& problem, double tolerance, true_type) {
+    return Integrator(0.0, epode::Tolerance<double>(problem.atol(tolerance), tolerance));
+}
+
+template<typename Integrator, typename Problem>
+Integrator makeIntegrator(const Problem&, double dv, false_type) {
+    return Integrator(dv);
+}
+
+template<typename Integrator>
+vector<double> sweep(double v0, double v1) {
+    vector<double> precisions;
+    if(Integrator::method_t::adaptive) {
+        for(int k = 3; k <= 10; ++k) precisions.push_back(pow(10.0, -k));
+    } else {
+        for(int k = 0; k < 10; ++k) precisions.push_back((v1 - v0) / (16.0 * pow(2.0, k)));
+    }
+    return precisions;
+}
+
+template<template<typename V, size_t N> class Integrator, typename Problem>
+void benchmark(const string& method, const Problem& problem, const typename Problem::State& ref,
+               const Settings& settings, vector<Point>& points) {
+    using integrator_t = Integrator<double, Problem::N>;
+    using adaptive_t = integral_constant<bool, integrator_t::method_t::adaptive>;
+    using clock_t = chrono::steady_clock;
+
+    const auto funcs = epode::fns(problem.system(), problem.pattern());
+    const auto end = (_v >= problem.v1()) || epode::triggers::maxEvals(settings.budget);
+    const auto output = epode::output::every(numeric_limits<size_t>::max()); // The final state only
+
+    size_t completed = 0;
+    auto best = numeric_limits<double>::infinity();
+    for(const auto precision : sweep<integrator_t>(problem.v0(), problem.v1())) {
+        auto integrator = makeIntegrator<integrator_t>(problem, precision, adaptive_t{});
+        auto point = Point{problem.name(), method, precision, numeric_limits<double>::quiet_NaN(),
+                           0.0, 0, 0, 0, "Failed"};
+        try {
+            auto seconds = numeric_limits<double>::infinity();
+            auto total = 0.0;
+            for(size_t repeat = 0; (repeat < settings.max_repeats) && (total < settings.min_seconds); ++repeat) {
+                const auto start = clock_t::now();
+                auto results = integrator(funcs, problem.v0(), end, problem.y0(), output);
+                const auto elapsed = chrono::duration<double>(clock_t::now() - start).count();
+
+                const auto& last = results.back();
+                point.error = error(last.y, ref);
+                point.evals = last.stats.evals + last.stats.jacobian_evals;
+                point.steps = last.stats.steps;
+                point.rejected = last.stats.rejected;
+                point.status = statusName(last.stats.status);
+
+                seconds = min(seconds, elapsed);
+                total += elapsed;
+                if(!point.completed()) break;
+            }
+            point.seconds = seconds;
+        } catch(const exception& e) {
+            point.status = string("Failed: ") + e.what();
+        }
+
+        if(point.completed()) {
+            completed += 1;
+            best = min(best, point.error);
+        }
+        points.push_back(point);
+    }
+
+    cout << "    " << left << setw(14) << method << right << setw(3) << completed << " of "
+         << sweep<integrator_t>(problem.v0(), problem.v1()).size() << " runs completed";
+    if(completed > 0) cout << ", best error " << scientific << setprecision(2) << best << defaultfloat;
+    cout << endl;
+}
+
+template<typename Problem>
+void benchmarkAll(const Problem& problem, const Settings& settings, vector<Point>& points) {
+    using namespace epode::integrator;
+
+    cout << problem.name() << (Problem::stiff ? " (stiff)" : "") << ":\n";
+    const auto ref = reference(problem, 0);
+
+    // GenericRK2 is parameterized; its named members (Heuns, Midpoint and Ralstons) are included
+    benchmark<Euler>("Euler", problem, ref, settings, points);
+    benchmark<HeunEuler>("HeunEuler", problem, ref, settings, points);
+    benchmark<RKF12>("RKF12", problem, ref, settings, points);
+    benchmark<Heuns>("Heuns", problem, ref, settings, points);
+    benchmark<Midpoint>("Midpoint", problem, ref, settings, points);
+    benchmark<Ralstons>("Ralstons", problem, ref, settings, points);
+    benchmark<RKF23>("RKF23", problem, ref, settings, points);
+    benchmark<RKF34>("RKF34", problem, ref, settings, points);
+    benchmark<BS32>("BS32", problem, ref, settings, points);
+    benchmark<RKF45>("RKF45", problem, ref, settings, points);
+    benchmark<BS45>("BS45", problem, ref, settings, points);
+    benchmark<DP45>("DP45", problem, ref, settings, points);
+    benchmark<Butcher5th>("Butcher5th", problem, ref, settings, points);
+    benchmark<DOP853>("DOP853", problem, ref, settings, points);
+    benchmark<ABM>("ABM", problem, ref, settings, points);
+    benchmark<Ros3>("Ros3", problem, ref, settings, points);
+    benchmark<Rodas3>("Rodas3", problem, ref, settings, points);
+    benchmark<Rodas4>("Rodas4", problem, ref, settings, points);
+    benchmark<Radau5>("Radau5", problem, ref, settings, points);
+    benchmark<BDF>("BDF", problem, ref, settings, points);
+    benchmark<SparseRadau5>("SparseRadau5", problem, ref, settings, points);
+    benchmark<SparseBDF>("SparseBDF", problem, ref, settings, points);
+}
+
+//
+// Output.  The CSV files have the columns
+//
+//      precision, error, seconds, evals, steps, rejected, log10(error), log10(seconds), log10(evals)
+//
+//  with the plotCSV.py name and label in comments.  Only completed runs are written.
+//
+void writeCSVs(const Settings& settings, const vector<Point>& points) {
+    for(auto it = points.begin(); it != points.end(); ) {
+        const auto last = find_if(it, points.end(), [&](const Point& p) {
+            return (p.problem != it->problem) || (p.method != it->method);
+        });
+
+        // A line needs at least two points (and plotCSV.py reads a single row as a flat array)
+        if(count_if(it, last, [](const Point& p) { return p.completed(); }) >= 2) {
+            ofstream file(settings.directory + "/wp_" + it->problem + "_" + it->method + ".csv");
+            file << "#name:" << it->problem << " work-precision\n";
+            file << "#label:" << it->method << "\n";
+            file << "# precision, error, seconds, evals, steps, rejected, log10(error), log10(seconds), log10(evals)\n";
+            file << setprecision(17);
+            for(auto p = it; p != last; ++p) {
+                if(!p->completed()) continue;
+                file << p->precision << ", " << p->error << ", " << p->seconds << ", " << p->evals << ", "
+                     << p->steps << ", " << p->rejected << ", " << log10(p->error) << ", "
+                     << log10(p->seconds) << ", " << log10(static_cast<double>(p->evals)) << "\n";
+            }
+        }
+        it = last;
+    }
+}
+
+// Non-finite values are not valid JSON, so they are written as null
+void writeJSONNumber(ostream& out, double value) {
+    if(isfinite(value)) {
+        out << value;
+    } else {
+        out << "null";
+    }
+}
+
+void writeJSON(const Settings& settings, const vector<Point>& points) {
+    ofstream file(settings.directory + "/workprecision.json");
+    file << setprecision(17) << "[\n";
+    for(size_t idx = 0; idx < points.size(); ++idx) {
+        const auto& p = points[idx];
+        file << "  {\"problem\": \"" << p.problem << "\", \"method\": \"" << p.method << "\", \"precision\": ";
+        writeJSONNumber(file, p.precision);
+        file << ", \"error\": ";
+        writeJSONNumber(file, p.error);
+        file << ", \"seconds\": ";
+        writeJSONNumber(file, p.seconds);
+        file << ", \"evals\": " << p.evals << ", \"steps\": " << p.steps << ", \"rejected\": " << p.rejected
+             << ", \"status\": \"" << p.status << "\"}" << ((idx + 1 < points.size()) ? ",\n" : "\n");
+    }
+    file << "]\n";
+}
+
+int main(int argc, char** argv)
+{
+    auto settings = Settings{};
+    if(argc > 1) settings.directory = argv[1];
+
+    vector<Point> points;
+    benchmarkAll(problems::Pendulum{}, settings, points);
+    benchmarkAll(problems::Capacitor{}, settings, points);
+    benchmarkAll(problems::VanDerPol{}, settings, points);
+    benchmarkAll(problems::StiffVanDerPol{}, settings, points);
+    benchmarkAll(problems::Lorenz{}, settings, points);
+    benchmarkAll(problems::Arenstorf{}, settings, points);
+    benchmarkAll(problems::Robertson{}, settings, points);
+    benchmarkAll(problems::Brusselator{}, settings, points);
+    benchmarkAll(problems::Pleiades{}, settings, points);
+
+    writeCSVs(settings, points);
+    writeJSON(settings, points);
+
+    return 0;
+}
@@ -0,0 +1,324 @@
+//
+//
+// File - Benchmarks/WorkPrecision/problems.h:
+//
+//      The standard test problems of the work-precision benchmark.  Each problem provides its
+//  system, a sparsity pattern of its Jacobian (for the sparse implicit methods), the integration
+//  interval and initial state, the absolute tolerance to pair with a relative tolerance and
+//  whether it is stiff.  The non-stiff problems are those of
+//  Hairer, Norsett and Wanner, "Solving Ordinary Differential Equations I", and the stiff problems
+//  those of volume II.
+//
+//
+// License:
+//
+//      This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0.
+//  If a copy of the MPL was not distributed with this file, You can obtain one
+//  at http://mozilla.org/MPL/2.0/.
+//
+//
+
+#ifndef EPODE_BENCHMARK_PROBLEMS_H
+#define EPODE_BENCHMARK_PROBLEMS_H
+
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <vector>
+
+#include <Eigen/Dense>
+#include <Eigen/Sparse>
+
+namespace problems
+{
+
+using Pattern = Eigen::SparseMatrix<double>;
+
+inline Pattern densePattern(int n) {
+    std::vector<Eigen::Triplet<double>> entries;
+    for(int i = 0; i < n; ++i) {
+        for(int j = 0; j < n; ++j) entries.emplace_back(i, j, 1.0);
+    }
+    Pattern pattern(n, n);
+    pattern.setFromTriplets(entries.begin(), entries.end());
+    return pattern;
+}
+
+// The damped pendulum of the Pendulum example
+struct Pendulum
+{
+        static constexpr size_t N = 2;
+        using State = Eigen::Matrix<double, 1, N>;
+        static constexpr bool stiff = false;
+
+        std::string name() const { return "pendulum"; }
+        double v0() const { return 0.0; }
+        double v1() const { return 2.0; }
+        double atol(double rtol) const { return rtol; }
+        State y0() const { return State{0, 0.35}; }
+        Pattern pattern() const { return densePattern(N); }
+
+        auto system() const {
+            const auto m = 1.0, L = 0.1, lambda = 1.0;
+            return [=](double, const State& y) {
+                return State{y[1], -(((lambda * y[1]) + ((9.81 * m) / L) * std::sin(y[0])) / m)};
+            };
+        }
+};
+
+// The RC discharge of the CapacitorDischarge example, which has an exact solution
+struct Capacitor
+{
+        static constexpr size_t N = 1;
+        using State = Eigen::Matrix<double, 1, N>;
+        static constexpr bool stiff = false;
+
+        std::string name() const { return "capacitor"; }
+        double v0() const { return 0.0; }
+        double v1() const { return 5.0; }
+        double atol(double rtol) const { return rtol; }
+        State y0() const { return State{5.0}; }
+        Pattern pattern() const { return densePattern(N); }
+
+        auto system() const {
+            const auto RC = 1.0;
+            return [=](double, const State& y) { return State{-y[0] / RC}; };
+        }
+
+        State exact() const { return State{5.0 * std::exp(-v1())}; }
+};
+
+//
+// The Van der Pol oscillator.  The stiff form is the scaled equation of Hairer and Wanner (II,
+//  section IV.10), eps*y2' = (1 - y1^2)*y2 - y1, with eps = 1e-6.
+//
+struct VanDerPol
+{
+        static constexpr size_t N = 2;
+        using State = Eigen::Matrix<double, 1, N>;
+        static constexpr bool stiff = false;
+
+        std::string name() const { return "vanderpol"; }
+        double v0() const { return 0.0; }
+        double v1() const { return 20.0; }
+        double atol(double rtol) const { return rtol; }
+        State y0() const { return State{2.0, 0.0}; }
+        Pattern pattern() const { return densePattern(N); }
+
+        auto system() const {
+            const auto mu = 1.0;
+            return [=](double, const State& y) {
+                return State{y[1], mu * (1.0 - y[0]*y[0]) * y[1] - y[0]};
+            };
+        }
+};
+
+struct StiffVanDerPol
+{
+        static constexpr size_t N = 2;
+        using State = Eigen::Matrix<double, 1, N>;
+        static constexpr bool stiff = true;
+
+        std::string name() const { return "vanderpol_stiff"; }
+        double v0() const { return 0.0; }
+        double v1() const { return 2.0; }
+        double atol(double rtol) const { return rtol; }
+        State y0() const { return State{2.0, -0.66}; }
+        Pattern pattern() const { return densePattern(N); }
+
+        auto system() const {
+            const auto eps = 1e-6;
+            return [=](double, const State& y) {
+                return State{y[1], ((1.0 - y[0]*y[0]) * y[1] - y[0]) / eps};
+            };
+        }
+};
+
+struct Lorenz
+{
+        static constexpr size_t N = 3;
+        using State = Eigen::Matrix<double, 1, N>;
+        static constexpr bool stiff = false;
+
+        std::string name() const { return "lorenz"; }
+        double v0() const { return 0.0; }
+        double v1() const { return 16.0; }
+        double atol(double rtol) const { return rtol; }
+        State y0() const { return State{-8.0, 8.0, 27.0}; }
+        Pattern pattern() const { return densePattern(N); }
+
+        auto system() const {
+            const auto sigma = 10.0, rho = 28.0, beta = 8.0/3.0;
+            return [=](double, const State& y) {
+                return State{sigma * (y[1] - y[0]), y[0] * (rho - y[2]) - y[1], y[0] * y[1] - beta * y[2]};
+            };
+        }
+};
+
+// The restricted three body problem, over one period of the Arenstorf orbit
+struct Arenstorf
+{
+        static constexpr size_t N = 4;
+        using State = Eigen::Matrix<double, 1, N>;
+        static constexpr bool stiff = false;
+
+        std::string name() const { return "arenstorf"; }
+        double v0() const { return 0.0; }
+        double v1() const { return 17.0652165601579625588917206249; }
+        double atol(double rtol) const { return rtol; }
+        State y0() const { return State{0.994, 0.0, 0.0, -2.00158510637908252240537862224}; }
+        Pattern pattern() const { return densePattern(N); }
+
+        auto system() const {
+            const auto mu = 0.012277471, mu_ = 1.0 - mu;
+            return [=](double, const State& y) {
+                const auto D1 = std::pow((y[0] + mu)*(y[0] + mu) + y[1]*y[1], 1.5);
+                const auto D2 = std::pow((y[0] - mu_)*(y[0] - mu_) + y[1]*y[1], 1.5);
+                return State{
+                    y[2],
+                    y[3],
+                    y[0] + 2.0*y[3] - mu_*(y[0] + mu)/D1 - mu*(y[0] - mu_)/D2,
+                    y[1] - 2.0*y[2] - mu_*y[1]/D1 - mu*y[1]/D2
+                };
+            };
+        }
+};
+
+// The chemical reaction of Robertson
+struct Robertson
+{
+        static constexpr size_t N = 3;
+        using State = Eigen::Matrix<double, 1, N>;
+        static constexpr bool stiff = true;
+
+        std::string name() const { return "robertson"; }
+        double v0() const { return 0.0; }
+        double v1() const { return 40.0; }
+        // The intermediate species is of order 1e-5, so the absolute tolerance is scaled below it
+        double atol(double rtol) const { return 1e-6 * rtol; }
+        State y0() const { return State{1.0, 0.0, 0.0}; }
+        Pattern pattern() const { return densePattern(N); }
+
+        auto system() const {
+            return [](double, const State& y) {
+                return State{
+                    -0.04*y[0] + 1e4*y[1]*y[2],
+                    0.04*y[0] - 1e4*y[1]*y[2] - 3e7*y[1]*y[1],
+                    3e7*y[1]*y[1]
+                };
+            };
+        }
+};
+
+//
+// The Brusselator with diffusion in one dimension, discretized by the method of lines on M
+//  interior points (Hairer and Wanner, II, section IV.10).  The state interleaves the two species,
+//  (u1, v1, u2, v2, ...), so the Jacobian is banded.
+//
+struct Brusselator
+{
+        static constexpr size_t M = 32;
+        static constexpr size_t N = 2*M;
+        using State = Eigen::Matrix<double, 1, N>;
+        static constexpr bool stiff = true;
+
+        std::string name() const { return "brusselator"; }
+        double v0() const { return 0.0; }
+        double v1() const { return 10.0; }
+        double atol(double rtol) const { return rtol; }
+
+        State y0() const {
+            State y;
+            for(size_t i = 0; i < M; ++i) {
+                const auto x = static_cast<double>(i + 1) / static_cast<double>(M + 1);
+                y[2*i] = 1.0 + std::sin(2.0 * M_PI * x);
+                y[2*i + 1] = 3.0;
+            }
+            return y;
+        }
+
+        Pattern pattern() const {
+            std::vector<Eigen::Triplet<double>> entries;
+            for(int i = 0; i < static_cast<int>(N); ++i) {
+                for(int j = std::max(0, i - 2); j <= std::min(static_cast<int>(N) - 1, i + 2); ++j) {
+                    entries.emplace_back(i, j, 1.0);
+                }
+            }
+            Pattern pattern(N, N);
+            pattern.setFromTriplets(entries.begin(), entries.end());
+            return pattern;
+        }
+
+        auto system() const {
+            const auto A = 1.0, B = 3.0, alpha = 1.0/50.0;
+            const auto c = alpha * static_cast<double>((M + 1) * (M + 1));
+            return [=](double, const State& y) {
+                State f;
+                for(size_t i = 0; i < M; ++i) {
+                    const auto u = y[2*i], v = y[2*i + 1];
+                    const auto u_left = (i == 0) ? 1.0 : y[2*i - 2];
+                    const auto v_left = (i == 0) ? 3.0 : y[2*i - 1];
+                    const auto u_right = (i == M - 1) ? 1.0 : y[2*i + 2];
+                    const auto v_right = (i == M - 1) ? 3.0 : y[2*i + 3];
+                    f[2*i] = A + u*u*v - (B + 1.0)*u + c*(u_left - 2.0*u + u_right);
+                    f[2*i + 1] = B*u - u*u*v + c*(v_left - 2.0*v + v_right);
+                }
+                return f;
+            };
+        }
+};
+
+//
+// The N-body problem of seven bodies in the plane (the Pleiades problem of Hairer, Norsett and
+//  Wanner, I, section II.10).  The state is (x, y, x', y') for all bodies.
+//
+struct Pleiades
+{
+        static constexpr size_t Bodies = 7;
+        static constexpr size_t N = 4*Bodies;
+        using State = Eigen::Matrix<double, 1, N>;
+        static constexpr bool stiff = false;
+
+        std::string name() const { return "nbody"; }
+        double v0() const { return 0.0; }
+        double v1() const { return 3.0; }
+        double atol(double rtol) const { return rtol; }
+
+        State y0() const {
+            State y;
+            y << 3, 3, -1, -3, 2, -2, 2,
+                 3, -3, 2, 0, 0, -4, 4,
+                 0, 0, 0, 0, 0, 1.75, -1.5,
+                 0, 0, 0, -1.25, 1, 0, 0;
+            return y;
+        }
+
+        Pattern pattern() const { return densePattern(N); }
+
+        auto system() const {
+            return [](double, const State& y) {
+                constexpr auto n = Bodies;
+                State f;
+                f.segment<2*n>(0) = y.segment<2*n>(2*n);
+                f.segment<2*n>(2*n).setZero();
+                for(size_t i = 0; i < n; ++i) {
+                    for(size_t j = i + 1; j < n; ++j) {
+                        const auto dx = y[j] - y[i];
+                        const auto dy = y[n + j] - y[n + i];
+                        const auto r2 = dx*dx + dy*dy;
+                        const auto r3 = r2 * std::sqrt(r2);
+                        // The mass of body k is k + 1
+                        f[2*n + i] += static_cast<double>(j + 1) * dx / r3;
+                        f[3*n + i] += static_cast<double>(j + 1) * dy / r3;
+                        f[2*n + j] -= static_cast<double>(i + 1) * dx / r3;
+                        f[3*n + j] -= static_cast<double>(i + 1) * dy / r3;
+                    }
+                }
+                return f;
+            };
+        }
+};
+
+} /*namespace problems*/
+
+#endif // EPODE_BENCHMARK_PROBLEMS_H
@@ -4,4 +4,5 @@ CONFIG += c++14
 
 SUBDIRS += \
     Library \
-    Examples
+    Examples \
+    Benchmarks
@@ -16,12 +16,13 @@ auto capacitorSystem = [] (auto C, auto R) {
     };
 };
 
-// This function returns a lambda expression that acts as a custom end trigger
-// TODO: THIS IS AN INTERMEDIATE METHOD FOR SOLVING THIS PROBLEM. FINALIZE THE SYNTAX.
+// This function returns an event which ends the integration when the voltage falls to V_end.
+//  The crossing is located within the step, so the discharge time does not depend on the step size.
 auto endTrigger(double V_end) {
-    return [=](auto /*dv*/, auto /*v*/, auto y, auto /*stats*/, auto /*limits*/) -> bool {
-        return y[0] <= V_end;
-    };
+    return epode::events::terminate(
+        [=](auto /*v*/, const auto& y) { return y[0] - V_end; },
+        epode::events::Direction::Falling
+    );
 }
 
 int main()
@@ -1,5 +1,6 @@
 #include <iostream>
 #include <sstream>
+#include <vector>
 
 #include <Eigen/Dense>
 #include <Epode/ode.h>
@@ -58,20 +59,25 @@ int main()
 	auto lambda_range = lambda_max - lambda_min;
 	auto lambda_step = lambda_range / (N - 1);
 
+	std::vector<double> lambdas;
 	for (int idx = 0; idx < N; ++idx) {
-		auto lambda = lambda_min + (idx * lambda_step);
+		lambdas.push_back(lambda_min + (idx * lambda_step));
+	}
 
-		auto results = epode::solve<method_t>(
-			pendulumSystem(1.0, 0.1, lambda),   // system parameters: m, L, lambda
-			dt,                                 // Initial step size
-			0,                                  // Start time
-			t_end,                              // End time
-			y0,                                 // Initial system state
-			1e-10							    // Error Tolerance
-		);
+	// Each damping value is an independent run, so the sweep is run in parallel
+	auto runs = epode::ensemble<method_t>(
+		[](auto lambda) { return pendulumSystem(1.0, 0.1, lambda); }, // system factory: m, L, lambda
+		lambdas,                            // system parameters
+		dt,                                 // Initial step size
+		0,                                  // Start time
+		t_end,                              // End time
+		y0,                                 // Initial system state
+		1e-10							    // Error Tolerance
+	);
 
-		epode::util::resultsToCSV(filename(idx), results, header(idx, lambda));
-		statistics(idx, results);
+	for (int idx = 0; idx < N; ++idx) {
+		epode::util::resultsToCSV(filename(idx), runs[idx], header(idx, lambdas[idx]));
+		statistics(idx, runs[idx]);
 	}
 
 	return 0;
@@ -0,0 +1,313 @@
+//
+//
+// File - Epode/adams.h:
+//
+//      Implementation of a variable-order (1 to 12), variable-step Adams-Bashforth-Moulton
+//  predictor-corrector method for smooth non-stiff systems.  The method is run in PECE mode: the
+//  Adams-Bashforth predictor, an Evaluation, the Adams-Moulton corrector of the same order and a
+//  final Evaluation at the corrected state.  A step therefore costs two function evaluations at
+//  any order, where a Runge-Kutta method of comparable accuracy needs six to twelve; the price is
+//  the memory of the history, up to fourteen states.
+//
+//      As in bdf.h, the history is kept as a Nordsieck array (see nordsieck.h) in the form used by
+//  the Adams methods of LSODE (Hindmarsh, "ODEPACK, a systematized collection of ODE solvers",
+//  1983), so step size changes only rescale the array.  The local error is estimated from the
+//  difference of the predicted and corrected states (Milne's device), with the error constants
+//  of the Adams formulas; the orders q-1, q and q+1 are compared after q+1 steps at the current
+//  order.  The history is restarted at first order if the caller moves the state.
+//
+//
+// License:
+//
+//      This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0.
+//  If a copy of the MPL was not distributed with this file, You can obtain one
+//  at http://mozilla.org/MPL/2.0/.
+//
+//
+
+#ifndef EPODE_ADAMS_H
+#define EPODE_ADAMS_H
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+#include "core.h"
+#include "dense.h"
+#include "nordsieck.h"
+#include "step.h"
+
+namespace epode
+{
+namespace method
+{
+
+// TODO: INCLUDE "ODEPACK, A SYSTEMATIZED COLLECTION OF ODE SOLVERS" (HINDMARSH) IN THE DOCUMENTATION
+template<typename Value, size_t N>
+class ABM : public internal::Adaptive<Value, 12>
+{
+    public:
+        using value_t = Value;
+        using state_t = internal::State<value_t, N>;
+        using return_t = internal::MethodReturnRef<value_t, state_t>;
+        using history_t = internal::NordsieckHistory<value_t, N, 12>;
+        using dense_t = typename history_t::dense_t;
+
+        static constexpr size_t max_order = history_t::max_order;
+
+        ABM(const Tolerance<value_t>& _tolerance = internal::defaultTolerance(1e-6, 5))
+            : internal::Adaptive<Value, 12>(_tolerance),
+              q(1), q_next(1), steps_at_order(0), v_(0), h(0), h_last(0),
+              have_error(false), initial(true) {
+            errorConstants(gamma, gamma_star);
+        }
+
+        //
+        // Start the history from the initial state: order one, with z[1] = dv*f(v0, y0)
+        //
+        template<typename Func>
+        void init(value_t dv, value_t v0, const state_t& y0, Func func) {
+            restart(func, dv, v0, y0);
+        }
+
+        template<typename Func, typename Limiter>
+        return_t operator () (Func func, value_t dv, value_t v, const state_t& y0, Limiter limiter) {
+            size_t evals = 0;
+
+            // The history belongs to the method; it is restarted if the caller moved the state
+            if((v != v_) || (h == value_t(0))) {
+                evals += restart(func, dv, v, y0);
+            }
+
+            // Apply the order and step size selected at the end of the last step
+            q = q_next;
+            auto dv_next = dv;
+            size_t error_failures = 0;
+            bool done = false;
+
+            do {
+                dv = limiter.constrain(dv_next);
+                if(dv != h) rescale(dv / h);
+
+                // Predict (Adams-Bashforth) and evaluate at the predicted state
+                z.predict(q);
+                coefficients(q, l);
+                internal::evaluate(func, v + dv, z[0], f);
+                evals += 1;
+
+                // Correct (Adams-Moulton); the correction is the predictor-corrector difference
+                delta = dv*f - z[1];
+                error = l[0] * delta;
+                y = z[0] + error;
+
+                const auto error_norm = errorCoefficient(q) * weightedNorm(error);
+                if((error_norm > this->tolerance.bound()) && (dv > limiter.min)) {
+                    z.retract(q);
+                    error_failures += 1;
+                    if(error_failures >= 3) {
+                        // Repeated failures: restart at first order from the last accepted state
+                        evals += restart(func, dv, v, z[0]);
+                        q = 1;
+                        dv_next = dv * value_t(0.1);
+                    } else {
+                        auto eta = stepRatio(error_norm, q + 1, value_t(1.2));
+                        if((error_failures > 1) && (q > 1)) {
+                            const auto eta_down = stepRatio(errorLower(), q, value_t(1.3));
+                            if(eta_down > eta) {
+                                q -= 1;
+                                eta = eta_down;
+                            }
+                        }
+                        dv_next = dv * std::max(value_t(0.2), std::min(value_t(0.9), eta));
+                    }
+                    have_error = false;
+                    steps_at_order = 0;
+                    continue;
+                }
+
+                // Evaluate at the corrected state and update the history with that derivative
+                internal::evaluate(func, v + dv, y, f);
+                evals += 1;
+                delta = dv*f - z[1];
+                z[0] = y;
+                for(size_t j = 1; j <= q; ++j) {
+                    z[j] += l[j] * delta;
+                }
+                done = true;
+            } while(!done);
+
+            v_ = v + dv;
+            h_last = dv;
+            steps_at_order += 1;
+
+            dv_next = dv * selectOrder(error_failures);
+            error_last = error;
+            have_error = (q_next == q);
+
+            return return_t{dv, dv_next, z[0], evals, error_failures};
+        }
+
+        // Dense output of the last step from the interpolating polynomial
+        dense_t dense() const {
+            return z.dense(v_, h_last, q);
+        }
+
+        size_t order() const { return q; }
+
+    protected:
+        //
+        // Coefficients of the order k corrector, l(x) = L(x) / L'(0) with
+        //  L(x) = integral from -1 to x of prod_{i=1}^{k-1} (u + i) du
+        //
+        static void coefficients(size_t k, std::array<value_t, max_order + 2>& c) {
+            auto p = std::array<value_t, max_order + 1>{};
+            p[0] = value_t(1);
+            for(size_t i = 1; i < k; ++i) {
+                for(size_t j = i; j > 0; --j) {
+                    p[j] = p[j-1] + value_t(i)*p[j];
+                }
+                p[0] *= value_t(i);
+            }
+
+            c.fill(value_t(0));
+            auto sign = value_t(1);
+            for(size_t j = 0; j < k; ++j) {
+                sign = -sign;
+                c[j+1] = p[j] / (value_t(j + 1) * p[0]);
+                c[0] -= sign * c[j+1];
+            }
+        }
+
+        //
+        // Error constants of the order k Adams-Bashforth (gamma) and Adams-Moulton (gamma_star)
+        //  formulas.
+        //
+        static void errorConstants(std::array<value_t, max_order + 2>& g, std::array<value_t, max_order + 2>& gs) {
+            for(size_t k = 0; k < g.size(); ++k) {
+                g[k] = value_t(1);
+                gs[k] = value_t(k == 0 ? 1 : 0);
+                for(size_t i = 0; i < k; ++i) {
+                    g[k] -= g[i] / value_t(k + 1 - i);
+                    gs[k] -= gs[i] / value_t(k + 1 - i);
+                }
+            }
+        }
+
+        // The local error of order k is |gamma*_k| / gamma_{k-1} times the corrector change
+        value_t errorCoefficient(size_t k) const {
+            return std::abs(gamma_star[k]) / gamma[k - 1];
+        }
+
+        // Local error estimate of the order q-1 formula, from z[q] = dv^q/q! * y^(q)
+        value_t errorLower() const {
+            auto factorial = value_t(1);
+            for(size_t i = 2; i <= q; ++i) factorial *= value_t(i);
+            return std::abs(gamma_star[q - 1]) * factorial * weightedNorm(z[q]);
+        }
+
+        // Norm of a change of the state, weighted by the current state for relative tolerances
+        template<typename Delta>
+        value_t weightedNorm(const Delta& d) const {
+            return this->tolerance.norm(z[0], z[0], d);
+        }
+
+        // Step ratio for a method with error constant power p, with a safety factor
+        value_t stepRatio(value_t error_norm, size_t p, value_t safety) const {
+            return value_t(1) / (safety * std::pow(error_norm / this->tolerance.bound(), value_t(1) / value_t(p)) + safety*value_t(1e-6));
+        }
+
+        //
+        // Choose the order and step ratio for the next step.  The orders q-1, q and q+1 are
+        //  compared after q+1 steps at the current order; otherwise the step size is kept.
+        //
+        value_t selectOrder(size_t error_failures) {
+            constexpr auto eta_min_change = value_t(1.1);
+            const auto eta_max = initial ? value_t(1e4) : ((error_failures > 0) ? value_t(1) : value_t(10));
+
+            q_next = q;
+            if(steps_at_order <= q) return value_t(1);
+
+            auto eta = stepRatio(errorCoefficient(q) * weightedNorm(error), q + 1, value_t(1.2));
+
+            auto eta_down = value_t(0);
+            if(q > 1) eta_down = stepRatio(errorLower(), q, value_t(1.3));
+
+            // The change of the corrections estimates dv^(q+2) * y^(q+2)
+            auto eta_up = value_t(0);
+            if((q < max_order) && have_error) {
+                const auto error_up = std::abs(gamma_star[q + 1]) * weightedNorm(error - error_last) / gamma[q - 1];
+                eta_up = stepRatio(error_up, q + 2, value_t(1.4));
+            }
+
+            size_t q_new = q;
+            if(eta_down > eta) {
+                eta = eta_down;
+                q_new = q - 1;
+            }
+            if(eta_up > eta) {
+                eta = eta_up;
+                q_new = q + 1;
+            }
+
+            eta = std::min(eta, eta_max);
+            if(eta < eta_min_change) return value_t(1);
+
+            if(q_new > q) {
+                // Estimate the new scaled derivative, dv^(q+1)/(q+1)! * y^(q+1), from the correction
+                auto factorial = value_t(1);
+                for(size_t i = 2; i <= q + 1; ++i) factorial *= value_t(i);
+                z[q + 1] = error / (gamma[q - 1] * factorial);
+            }
+            q_next = q_new;
+            steps_at_order = 0;
+            initial = false;
+            return eta;
+        }
+
+        // Restart the history at first order from (v, y), returning the number of evaluations
+        template<typename Func>
+        size_t restart(Func& func, value_t dv, value_t v, const state_t& y0) {
+            internal::evaluate(func, v, y0, f);
+            z.reset(dv, y0, f);
+            error_last.setZero(y0.size());
+            q = q_next = 1;
+            steps_at_order = 0;
+            have_error = false;
+            initial = true;
+            v_ = v;
+            h = dv;
+            h_last = dv;
+            return 1;
+        }
+
+        // Rescale the history for a step ratio eta
+        void rescale(value_t eta) {
+            z.rescale(q, eta);
+            error_last *= std::pow(eta, value_t(q + 1));
+            h *= eta;
+        }
+
+        size_t q;               // Current order
+        size_t q_next;          // Order of the next step
+        size_t steps_at_order;  // Steps taken since the last order or step size change
+        value_t v_;             // The integration variable at z[0]
+        value_t h;              // The step size of the history scaling
+        value_t h_last;         // The last step taken
+        bool have_error;        // The last correction was made at the current order
+        bool initial;           // No step size change yet; allow a large first increase
+
+        std::array<value_t, max_order + 2> l;
+        std::array<value_t, max_order + 2> gamma;
+        std::array<value_t, max_order + 2> gamma_star;
+        history_t z;
+        state_t y;
+        state_t f;
+        state_t delta;
+        state_t error;
+        state_t error_last;
+};
+
+} /*namespace method*/
+} /*namespace epode*/
+
+#endif // EPODE_ADAMS_H
@@ -0,0 +1,142 @@
+//
+//
+// File - Epode/allocation.h:
+//
+//      A heap allocation counter for checking that integration loops do not allocate.  Counting
+//  is only enabled when EPODE_COUNT_ALLOCATIONS is defined; otherwise the counters always read
+//  zero and this file has no effect.  It is intended for small, single translation unit test
+//  programs, as enabling it replaces the global operator new and hooks the Eigen allocator:
+//
+//      - Every form of the global operator new increments the counter.
+//      - Eigen allocates dynamic matrices with malloc, not operator new.  The counter builds Eigen
+//          with EIGEN_RUNTIME_NO_MALLOC, permanently disallows Eigen heap allocations and turns
+//          the resulting Eigen assertion into a count.  This file must therefore be included
+//          before any Eigen (or Epode) header.
+//
+//      Typical usage is to take a few steps with a stepper (so that all of the buffers have been
+//  sized), then count the allocations of the following steps:
+//
+//          epode::util::AllocationCount count;
+//          for(size_t idx = 0; idx < 100; ++idx) stepper.step();
+//          assert(count.allocations() == 0);
+//
+//      This file is not included by ode.h.  Benchmarks/Allocations checks every dense method in
+//  this way.
+//
+//
+// License:
+//
+//      This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0.
+//  If a copy of the MPL was not distributed with this file, You can obtain one
+//  at http://mozilla.org/MPL/2.0/.
+//
+//
+
+#ifndef EPODE_ALLOCATION_H
+#define EPODE_ALLOCATION_H
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+namespace epode
+{
+namespace util
+{
+namespace internal
+{
+inline std::atomic<size_t>& allocationCounter() {
+    static std::atomic<size_t> counter{0};
+    return counter;
+}
+
+inline void countAllocation() {
+    allocationCounter().fetch_add(1, std::memory_order_relaxed);
+}
+
+// Count the Eigen heap allocation check and fail on any other Eigen assertion
+inline void eigenAssertion(const char* condition, const char* file, int line) {
+    if(std::strstr(condition, "heap allocation is forbidden") != nullptr) {
+        countAllocation();
+        return;
+    }
+    std::fprintf(stderr, "%s:%d: Eigen assertion failed: %s\n", file, line, condition);
+    std::abort();
+}
+} /*namespace internal*/
+
+// The total number of heap allocations counted since program start
+inline size_t allocations() {
+    return internal::allocationCounter().load(std::memory_order_relaxed);
+}
+
+// Count the allocations made (by any thread) since construction
+class AllocationCount
+{
+    public:
+        AllocationCount() : start(util::allocations()) {}
+
+        size_t allocations() const { return util::allocations() - start; }
+        void reset() { start = util::allocations(); }
+
+    protected:
+        size_t start;
+};
+
+} /*namespace util*/
+} /*namespace epode*/
+
+#ifdef EPODE_COUNT_ALLOCATIONS
+
+#ifdef EIGEN_CORE_H
+#error "Epode/allocation.h must be included before any Eigen header when EPODE_COUNT_ALLOCATIONS is defined"
+#endif
+
+#define EIGEN_RUNTIME_NO_MALLOC
+#define eigen_assert(x) \
+    do { if(!(x)) epode::util::internal::eigenAssertion(#x, __FILE__, __LINE__); } while(false)
+
+#include <Eigen/Core>
+
+namespace epode
+{
+namespace util
+{
+namespace internal
+{
+static const bool eigen_allocations_counted = !Eigen::internal::set_is_malloc_allowed(false);
+} /*namespace internal*/
+} /*namespace util*/
+} /*namespace epode*/
+
+void* operator new(std::size_t size) {
+    epode::util::internal::countAllocation();
+    if(void* ptr = std::malloc((size == 0) ? 1 : size)) return ptr;
+    throw std::bad_alloc{};
+}
+
+void* operator new[](std::size_t size) {
+    return ::operator new(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    try {
+        return ::operator new(size);
+    } catch(...) {
+        return nullptr;
+    }
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    return ::operator new(size, std::nothrow);
+}
+
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete[](void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::size_t) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, std::size_t) noexcept { std::free(ptr); }
+#endif // EPODE_COUNT_ALLOCATIONS
+
+#endif // EPODE_ALLOCATION_H
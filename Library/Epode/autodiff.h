@@ -0,0 +1,362 @@
+//
+//
+// File - Epode/autodiff.h:
+//
+//      Forward-mode automatic differentiation of system functions.  A system function written
+//  as a generic lambda can be instantiated with the Dual scalar, a value together with a small
+//  fixed-width block of tangents.  Seeding Width columns of the identity in the tangents of the
+//  state gives Width columns of the Jacobian from a single evaluation, exactly and without the
+//  step size selection of finite differences.
+//
+//      The Jacobian provider is used as the Jacobian function of the implicit methods:
+//
+//          auto f = [](auto, auto y) { return decltype(y){ y[1], -sin(y[0]) }; };
+//          auto results = Integrator<double, 2, method::Radau5>(dv, tol)(fns(f, autoJacobian(f)), ...);
+//
+//  For this, the system function must compute with the scalar type of its state argument: the
+//  derivative has to be built from the state type (decltype(y) above, not a fixed double state)
+//  and the math functions have to be called unqualified (sin(x), not std::sin(x)) so that the
+//  Dual overloads are found.  Sparse Jacobians (see sparse.h) are computed from compressed
+//  seeds, with one color of the sparsity pattern per tangent, and need the pattern to be passed,
+//  fns(f, autoJacobian(f), pattern).
+//
+//
+// License:
+//
+//      This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0.
+//  If a copy of the MPL was not distributed with this file, You can obtain one
+//  at http://mozilla.org/MPL/2.0/.
+//
+//
+
+#ifndef EPODE_AUTODIFF_H
+#define EPODE_AUTODIFF_H
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <type_traits>
+
+#include <Eigen/Dense>
+
+#include "core.h"
+#include "implicit.h"
+
+namespace epode
+{
+//
+// A value with Width tangent (directional derivative) components
+//
+template<typename Value, size_t Width>
+class Dual
+{
+    public:
+        using value_t = Value;
+        using tangent_t = Eigen::Array<Value, static_cast<int>(Width), 1>;
+
+        Dual() : v(0), d(tangent_t::Zero()) {}
+        Dual(const value_t& _v) : v(_v), d(tangent_t::Zero()) {}
+        Dual(const value_t& _v, const tangent_t& _d) : v(_v), d(_d) {}
+
+        template<typename T, typename = std::enable_if_t<std::is_arithmetic<T>::value> >
+        Dual(const T& _v) : v(value_t(_v)), d(tangent_t::Zero()) {}
+
+        Dual& operator += (const Dual& _other) { v += _other.v; d += _other.d; return *this; }
+        Dual& operator -= (const Dual& _other) { v -= _other.v; d -= _other.d; return *this; }
+        Dual& operator *= (const Dual& _other) { d = d*_other.v + v*_other.d; v *= _other.v; return *this; }
+        Dual& operator /= (const Dual& _other) {
+            const auto inv = value_t(1) / _other.v;
+            v *= inv;
+            d = (d - v*_other.d) * inv;
+            return *this;
+        }
+
+        value_t v;
+        tangent_t d;
+};
+
+namespace internal
+{
+// Mixed operations are only defined with arithmetic types, which are converted to the value type
+template<typename T>
+using Arithmetic = std::enable_if_t<std::is_arithmetic<T>::value>;
+} /*namespace internal*/
+
+//
+// Arithmetic operators
+//
+template<typename V, size_t W>
+Dual<V, W> operator + (const Dual<V, W>& a) { return a; }
+
+template<typename V, size_t W>
+Dual<V, W> operator - (const Dual<V, W>& a) { return Dual<V, W>(-a.v, -a.d); }
+
+template<typename V, size_t W>
+Dual<V, W> operator + (const Dual<V, W>& a, const Dual<V, W>& b) { return Dual<V, W>(a.v + b.v, a.d + b.d); }
+
+template<typename V, size_t W>
+Dual<V, W> operator - (const Dual<V, W>& a, const Dual<V, W>& b) { return Dual<V, W>(a.v - b.v, a.d - b.d); }
+
+template<typename V, size_t W>
+Dual<V, W> operator * (const Dual<V, W>& a, const Dual<V, W>& b) { return Dual<V, W>(a.v * b.v, a.d*b.v + a.v*b.d); }
+
+template<typename V, size_t W>
+Dual<V, W> operator / (const Dual<V, W>& a, const Dual<V, W>& b) {
+    const auto inv = V(1) / b.v;
+    const auto v = a.v * inv;
+    return Dual<V, W>(v, (a.d - v*b.d) * inv);
+}
+
+template<typename V, size_t W, typename T, typename = internal::Arithmetic<T>>
+Dual<V, W> operator + (const Dual<V, W>& a, const T& b) { return Dual<V, W>(a.v + V(b), a.d); }
+
+template<typename V, size_t W, typename T, typename = internal::Arithmetic<T>>
+Dual<V, W> operator + (const T& a, const Dual<V, W>& b) { return Dual<V, W>(V(a) + b.v, b.d); }
+
+template<typename V, size_t W, typename T, typename = internal::Arithmetic<T>>
+Dual<V, W> operator - (const Dual<V, W>& a, const T& b) { return Dual<V, W>(a.v - V(b), a.d); }
+
+template<typename V, size_t W, typename T, typename = internal::Arithmetic<T>>
+Dual<V, W> operator - (const T& a, const Dual<V, W>& b) { return Dual<V, W>(V(a) - b.v, -b.d); }
+
+template<typename V, size_t W, typename T, typename = internal::Arithmetic<T>>
+Dual<V, W> operator * (const Dual<V, W>& a, const T& b) {
+    const auto s = V(b);
+    return Dual<V, W>(a.v * s, a.d * s);
+}
+
+template<typename V, size_t W, typename T, typename = internal::Arithmetic<T>>
+Dual<V, W> operator * (const T& a, const Dual<V, W>& b) {
+    const auto s = V(a);
+    return Dual<V, W>(s * b.v, s * b.d);
+}
+
+template<typename V, size_t W, typename T, typename = internal::Arithmetic<T>>
+Dual<V, W> operator / (const Dual<V, W>& a, const T& b) {
+    const auto inv = V(1) / V(b);
+    return Dual<V, W>(a.v * inv, a.d * inv);
+}
+
+template<typename V, size_t W, typename T, typename = internal::Arithmetic<T>>
+Dual<V, W> operator / (const T& a, const Dual<V, W>& b) {
+    const auto inv = V(1) / b.v;
+    const auto v = V(a) * inv;
+    return Dual<V, W>(v, (-v * inv) * b.d);
+}
+
+//
+// Comparisons use the values only
+//
+#define EPODE_DUAL_COMPARISON(OP) \
+    template<typename V, size_t W> \
+    bool operator OP (const Dual<V, W>& a, const Dual<V, W>& b) { return a.v OP b.v; } \
+    template<typename V, size_t W, typename T, typename = internal::Arithmetic<T>> \
+    bool operator OP (const Dual<V, W>& a, const T& b) { return a.v OP V(b); } \
+    template<typename V, size_t W, typename T, typename = internal::Arithmetic<T>> \
+    bool operator OP (const T& a, const Dual<V, W>& b) { return V(a) OP b.v; }
+
+EPODE_DUAL_COMPARISON(<)
+EPODE_DUAL_COMPARISON(>)
+EPODE_DUAL_COMPARISON(<=)
+EPODE_DUAL_COMPARISON(>=)
+EPODE_DUAL_COMPARISON(==)
+EPODE_DUAL_COMPARISON(!=)
+
+#undef EPODE_DUAL_COMPARISON
+
+//
+// Math functions, found by argument dependent lookup when called unqualified.  Each applies the
+//  chain rule, f(v + d) = f(v) + f'(v)*d.
+//
+#define EPODE_DUAL_FUNCTION(NAME, VALUE, DERIVATIVE) \
+    template<typename V, size_t W> \
+    Dual<V, W> NAME (const Dual<V, W>& x) { \
+        using std::sin; using std::cos; using std::tan; using std::exp; using std::log; \
+        using std::sqrt; using std::sinh; using std::cosh; using std::tanh; \
+        const V value = VALUE; \
+        const V derivative = DERIVATIVE; \
+        return Dual<V, W>(value, derivative * x.d); \
+    }
+
+EPODE_DUAL_FUNCTION(sin, sin(x.v), cos(x.v))
+EPODE_DUAL_FUNCTION(cos, cos(x.v), -sin(x.v))
+EPODE_DUAL_FUNCTION(tan, tan(x.v), V(1) + value*value)
+EPODE_DUAL_FUNCTION(exp, exp(x.v), value)
+EPODE_DUAL_FUNCTION(log, log(x.v), V(1) / x.v)
+EPODE_DUAL_FUNCTION(sqrt, sqrt(x.v), V(1) / (V(2) * value))
+EPODE_DUAL_FUNCTION(sinh, sinh(x.v), cosh(x.v))
+EPODE_DUAL_FUNCTION(cosh, cosh(x.v), sinh(x.v))
+EPODE_DUAL_FUNCTION(tanh, tanh(x.v), V(1) - value*value)
+EPODE_DUAL_FUNCTION(asin, std::asin(x.v), V(1) / sqrt(V(1) - x.v*x.v))
+EPODE_DUAL_FUNCTION(acos, std::acos(x.v), V(-1) / sqrt(V(1) - x.v*x.v))
+EPODE_DUAL_FUNCTION(atan, std::atan(x.v), V(1) / (V(1) + x.v*x.v))
+EPODE_DUAL_FUNCTION(abs, std::abs(x.v), (x.v < V(0)) ? V(-1) : V(1))
+EPODE_DUAL_FUNCTION(fabs, std::abs(x.v), (x.v < V(0)) ? V(-1) : V(1))
+
+#undef EPODE_DUAL_FUNCTION
+
+template<typename V, size_t W, typename T, typename = internal::Arithmetic<T>>
+Dual<V, W> pow(const Dual<V, W>& x, const T& p) {
+    const auto e = V(p);
+    const auto value = std::pow(x.v, e);
+    return Dual<V, W>(value, (e * std::pow(x.v, e - V(1))) * x.d);
+}
+
+template<typename V, size_t W>
+Dual<V, W> pow(const Dual<V, W>& x, const Dual<V, W>& p) {
+    return exp(p * log(x));
+}
+
+template<typename V, size_t W, typename T, typename = internal::Arithmetic<T>>
+Dual<V, W> pow(const T& x, const Dual<V, W>& p) {
+    const auto b = V(x);
+    const auto value = std::pow(b, p.v);
+    return Dual<V, W>(value, (value * std::log(b)) * p.d);
+}
+
+template<typename V, size_t W>
+Dual<V, W> atan2(const Dual<V, W>& y, const Dual<V, W>& x) {
+    const auto inv = V(1) / (x.v*x.v + y.v*y.v);
+    return Dual<V, W>(std::atan2(y.v, x.v), (x.v*inv)*y.d - (y.v*inv)*x.d);
+}
+
+template<typename V, size_t W>
+Dual<V, W> min(const Dual<V, W>& a, const Dual<V, W>& b) { return (b < a) ? b : a; }
+
+template<typename V, size_t W>
+Dual<V, W> max(const Dual<V, W>& a, const Dual<V, W>& b) { return (a < b) ? b : a; }
+
+namespace internal
+{
+//
+// Jacobian function computed by forward-mode differentiation of a generic system function.
+//  Dense Jacobians take ceil(N / Width) evaluations; sparse Jacobians take ceil(colors / Width)
+//  evaluations for a coloring of the (already present) structure of J.  The evaluations (each
+//  in Dual arithmetic) are returned, so they are counted as Jacobian evaluations.
+//
+template<typename Func, size_t Width>
+class AutoJacobian
+{
+    public:
+        AutoJacobian(const Func& _func) : func(_func) {}
+
+        template<typename Value, typename YState, typename Matrix>
+        size_t operator () (const Value& v, const YState& y, Eigen::MatrixBase<Matrix>& J) {
+            using dual_t = Dual<typename YState::Scalar, Width>;
+            using dual_state_t = Eigen::Matrix<dual_t, 1, YState::ColsAtCompileTime>;
+
+            const auto n = y.size();
+            auto& jac = J.derived();
+            jac.resize(n, n);
+
+            dual_state_t yd = y.template cast<dual_t>();
+            dual_state_t fd;
+            size_t evals = 0;
+            for(Eigen::Index first = 0; first < n; first += Width) {
+                const auto width = std::min<Eigen::Index>(Width, n - first);
+                for(Eigen::Index k = 0; k < width; ++k) yd[first + k].d[k] = 1;
+                evaluate(func, v, yd, fd);
+                evals += 1;
+                for(Eigen::Index row = 0; row < n; ++row) {
+                    for(Eigen::Index k = 0; k < width; ++k) jac(row, first + k) = fd[row].d[k];
+                }
+                for(Eigen::Index k = 0; k < width; ++k) yd[first + k].d[k] = 0;
+            }
+            return evals;
+        }
+
+        template<typename Value, typename YState, typename Sparse, typename = std::enable_if_t<isPattern<Sparse>::value> >
+        size_t operator () (const Value& v, const YState& y, Sparse& J) {
+            using dual_t = Dual<typename YState::Scalar, Width>;
+            using dual_state_t = Eigen::Matrix<dual_t, 1, YState::ColsAtCompileTime>;
+
+            if(J.nonZeros() == 0) {
+                throw std::invalid_argument("epode: automatic sparse Jacobians require a sparsity pattern, fns(f, jac, pattern)");
+            }
+            J.makeCompressed();
+            if(static_cast<Eigen::Index>(coloring.rows.size()) != J.nonZeros()) coloring = colorColumns(J);
+
+            dual_state_t yd = y.template cast<dual_t>();
+            dual_state_t fd;
+            const auto colors = coloring.colors();
+            size_t evals = 0;
+            for(size_t first = 0; first < colors; first += Width) {
+                const auto width = std::min<size_t>(Width, colors - first);
+                seed(yd, first, width, 1);
+                evaluate(func, v, yd, fd);
+                evals += 1;
+                for(size_t k = 0; k < width; ++k) {
+                    for(auto idx = coloring.color_start[first + k]; idx < coloring.color_start[first + k + 1]; ++idx) {
+                        const auto col = coloring.columns[idx];
+                        for(auto e = coloring.row_start[col]; e < coloring.row_start[col+1]; ++e) {
+                            J.valuePtr()[J.outerIndexPtr()[col] + (e - coloring.row_start[col])] = fd[coloring.rows[e]].d[k];
+                        }
+                    }
+                }
+                seed(yd, first, width, 0);
+            }
+            return evals;
+        }
+
+    protected:
+        // Set the tangent k of every column of color first + k
+        template<typename DualState>
+        void seed(DualState& yd, size_t first, size_t width, int value) const {
+            for(size_t k = 0; k < width; ++k) {
+                for(auto idx = coloring.color_start[first + k]; idx < coloring.color_start[first + k + 1]; ++idx) {
+                    yd[coloring.columns[idx]].d[k] = value;
+                }
+            }
+        }
+
+        Func func;
+        ColumnColoring coloring;
+};
+} /*namespace internal*/
+
+//
+// Create a Jacobian function for a generic system function.  Width is the number of Jacobian
+//  columns computed per evaluation of the system function.
+//
+template<size_t Width = 4, typename Func>
+auto autoJacobian(const Func& func) {
+    return internal::AutoJacobian<Func, Width>(func);
+}
+
+} /*namespace epode*/
+
+namespace Eigen
+{
+template<typename Value, size_t Width>
+struct NumTraits<epode::Dual<Value, Width>> : NumTraits<Value>
+{
+        using Real = epode::Dual<Value, Width>;
+        using NonInteger = epode::Dual<Value, Width>;
+        using Nested = epode::Dual<Value, Width>;
+        using Literal = epode::Dual<Value, Width>;
+
+        enum {
+            IsComplex = 0,
+            IsInteger = 0,
+            IsSigned = 1,
+            RequireInitialization = 1,
+            ReadCost = static_cast<int>(Width) + 1,
+            AddCost = static_cast<int>(Width) + 1,
+            MulCost = 2*static_cast<int>(Width) + 1
+        };
+};
+
+template<typename Value, size_t Width, typename BinaryOp>
+struct ScalarBinaryOpTraits<epode::Dual<Value, Width>, Value, BinaryOp>
+{
+        using ReturnType = epode::Dual<Value, Width>;
+};
+
+template<typename Value, size_t Width, typename BinaryOp>
+struct ScalarBinaryOpTraits<Value, epode::Dual<Value, Width>, BinaryOp>
+{
+        using ReturnType = epode::Dual<Value, Width>;
+};
+} /*namespace Eigen*/
+
+#endif // EPODE_AUTODIFF_H
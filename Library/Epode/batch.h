@@ -0,0 +1,265 @@
+//
+//
+// File - Epode/batch.h:
+//
+//      Lockstep integration of a batch of small, independent systems.  For systems with only a
+//  handful of states, the per-step work of a scalar integration is dominated by overhead.  In
+//  batch mode, the states of Lanes systems are stored side by side in a single Eigen matrix (one
+//  column per lane, with each state component stored contiguously across the lanes) and the
+//  system function is called once for all of the lanes.  The stage combinations are then single
+//  Eigen expressions over the whole batch, which Eigen vectorizes across the lanes.
+//
+//      The adaptive batched methods keep a step size, integration variable value and end value
+//  per lane.  Lanes which reject a step retry with a smaller step on the next lockstep iteration
+//  while the accepted lanes continue; lanes which have reached their end value are masked out
+//  (they take zero-length steps) until all lanes have finished.
+//
+//      The batched system function is called as f(v, y) where v is a BatchValue (the value of the
+//  integration variable for every lane) and y is a BatchState.  It must return a BatchState.
+//
+//
+// License:
+//
+//      This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0.
+//  If a copy of the MPL was not distributed with this file, You can obtain one
+//  at http://mozilla.org/MPL/2.0/.
+//
+//
+
+#ifndef EPODE_BATCH_H
+#define EPODE_BATCH_H
+
+#include <cmath>
+#include <limits>
+
+#include <Eigen/Dense>
+
+#include "core.h"
+
+namespace epode
+{
+namespace batch
+{
+namespace internal
+{
+// Eigen requires single column matrices to be column-major and single row matrices to be row-major
+template<size_t N, size_t Lanes>
+struct BatchStorage
+{
+        static constexpr int options = (Lanes == 1) ? Eigen::ColMajor : Eigen::RowMajor;
+};
+} /*namespace internal*/
+
+// The states of all lanes, one lane per column.  Rows are contiguous so that operations on a
+//  state component are vectorized across the lanes.
+template<typename Value, size_t N, size_t Lanes>
+using BatchState = Eigen::Matrix<Value, N, Lanes, internal::BatchStorage<N, Lanes>::options>;
+
+// A scalar value per lane
+template<typename Value, size_t Lanes>
+using BatchValue = Eigen::Array<Value, 1, Lanes>;
+
+// A flag per lane
+template<size_t Lanes>
+using BatchMask = Eigen::Array<bool, 1, Lanes>;
+
+template<typename Value, size_t N, size_t Lanes>
+struct BatchMethodReturn
+{
+        using value_t = Value;
+        using lanes_t = BatchValue<value_t, Lanes>;
+        using mask_t = BatchMask<Lanes>;
+
+        mask_t accepted; // Lanes which accepted their step
+        lanes_t dv_next; // Next step size per lane
+        size_t evals;    // Function evaluations for the whole batch
+};
+
+template<typename Value, size_t N, size_t Lanes>
+struct BatchResult
+{
+        using value_t = Value;
+        using lanes_t = BatchValue<value_t, Lanes>;
+        using state_t = BatchState<value_t, N, Lanes>;
+        using counts_t = Eigen::Array<size_t, 1, Lanes>;
+
+        lanes_t v;          // Final value of the integration variable per lane
+        state_t y;          // Final state per lane
+        size_t steps = 0;   // Lockstep iterations
+        size_t evals = 0;   // Batched function evaluations
+        counts_t accepted;  // Accepted steps per lane
+        counts_t rejected;  // Rejected steps per lane
+};
+
+namespace method
+{
+//
+// Batched Bogacki-Shampine 3(2) with per-lane step size control.  A single call attempts one step
+//  on every lane with its own step size, so a call costs three batched evaluations whatever the
+//  mix of accepted and rejected lanes.
+//
+template<typename Value, size_t N, size_t Lanes>
+class BS32 : public epode::internal::Adaptive<Value, 3>
+{
+    public:
+        using value_t = Value;
+        using state_t = BatchState<value_t, N, Lanes>;
+        using lanes_t = BatchValue<value_t, Lanes>;
+        using mask_t = BatchMask<Lanes>;
+        using return_t = BatchMethodReturn<value_t, N, Lanes>;
+
+        using epode::internal::Adaptive<Value, 3>::Adaptive; // Inherit Construtors
+
+        template<typename Func>
+        void init(const lanes_t& v0, const state_t& y0, Func func) {
+            k0 = func(v0, y0);
+        }
+
+        // Attempt a step of dv on every lane.  Lanes with a zero step are left unchanged.
+        template<typename Func>
+        return_t operator () (Func func, const lanes_t& dv, const lanes_t& v, state_t& y, value_t dv_min) {
+            constexpr auto c0 = value_t(1) / value_t(2);
+            constexpr auto c1 = value_t(3) / value_t(4);
+            constexpr auto c2 = value_t(2) / value_t(9);
+            constexpr auto c3 = value_t(1) / value_t(3);
+            constexpr auto c4 = value_t(4) / value_t(9);
+            constexpr auto c5 = value_t(7) / value_t(24);
+            constexpr auto c6 = value_t(1) / value_t(4);
+            constexpr auto c7 = value_t(1) / value_t(8);
+            constexpr auto scale_min = value_t(0.33);
+            constexpr auto scale_max = value_t(3.0);
+
+            k1 = func(v + c0*dv, y + scaled(dv, c0*k0));
+            k2 = func(v + c1*dv, y + scaled(dv, c1*k1));
+            y1 = y + scaled(dv, c2*k0 + c3*k1 + c4*k2);
+            k3 = func(v + dv, y1);
+
+            const state_t delta = scaled(dv, (c5-c2)*k0 + (c6-c3)*k1 + (c3-c4)*k2 + c7*k3);
+            lanes_t error;
+            for(Eigen::Index lane = 0; lane < delta.cols(); ++lane) {
+                error(lane) = this->tolerance.norm(y.col(lane), y1.col(lane), delta.col(lane));
+            }
+
+            // The same elementary controller as step::internal::updateStepSize, per lane
+            const lanes_t scale = (error == value_t(0)).select(
+                lanes_t::Constant(scale_max),
+                (this->tolerance.bound() / error).sqrt()
+            );
+
+            return_t result;
+            result.accepted = (scale >= value_t(1)) || (dv <= dv_min);
+            result.dv_next = result.accepted.select(
+                dv * scale.min(scale_max),
+                dv * scale.max(scale_min)
+            );
+            result.evals = 3;
+
+            // Accepted lanes take the new state and, by FSAL, the new first stage
+            const auto accepted = result.accepted.template replicate<N, 1>();
+            y = accepted.select(y1, y);
+            k0 = accepted.select(k3, k0);
+            return result;
+        }
+
+    protected:
+        template<typename K>
+        static state_t scaled(const lanes_t& dv, const K& k) {
+            return (k.array().rowwise() * dv).matrix();
+        }
+
+        state_t k0;
+        state_t k1;
+        state_t k2;
+        state_t k3;
+        state_t y1;
+};
+} /*namespace method*/
+
+//
+// Integrate a batch of systems in lockstep until every lane has reached its end value
+//
+template<typename Value, size_t N, size_t Lanes,
+         template<typename V, size_t N2, size_t L> class Method = method::BS32>
+class BatchIntegrator
+{
+    public:
+        using value_t = Value;
+        using method_t = Method<value_t, N, Lanes>;
+        using state_t = BatchState<value_t, N, Lanes>;
+        using lanes_t = BatchValue<value_t, Lanes>;
+        using mask_t = BatchMask<Lanes>;
+        using result_t = BatchResult<value_t, N, Lanes>;
+
+        template<typename... Args>
+        BatchIntegrator(value_t _dv0, Args... args) : dv0(_dv0), dv_min(value_t(0)), method(args...) {}
+
+        // Set the minimum step size, at which a step is accepted whatever its error estimate
+        BatchIntegrator& minimumStep(value_t _dv_min) {
+            dv_min = _dv_min;
+            return *this;
+        }
+
+        template<typename Func>
+        result_t operator() (Func func, const lanes_t& v0, const lanes_t& v1, const state_t& y0) {
+            return this->operator()(func, v0, v1, y0, [](const lanes_t&, const state_t&, const mask_t&){});
+        }
+
+        template<typename Func>
+        result_t operator() (Func func, value_t v0, value_t v1, const state_t& y0) {
+            return this->operator()(func, lanes_t::Constant(v0), lanes_t::Constant(v1), y0);
+        }
+
+        //
+        // The observer is called after each lockstep iteration with the integration variable
+        //  values, the states and the mask of the lanes which accepted a step.
+        //
+        template<typename Func, typename Observer>
+        result_t operator() (Func func, const lanes_t& v0, const lanes_t& v1, const state_t& y0, Observer observer) {
+            const auto eps = value_t(16) * std::numeric_limits<value_t>::epsilon();
+
+            result_t result;
+            result.v = v0;
+            result.y = y0;
+            result.accepted.setZero();
+            result.rejected.setZero();
+
+            auto m = method;
+            m.init(result.v, result.y, func);
+            result.evals += 1;
+
+            lanes_t dv = lanes_t::Constant(dv0);
+            auto remaining = [&]() -> lanes_t { return (v1 - result.v).max(value_t(0)); };
+            auto active = [&]() -> mask_t { return remaining() > eps * v1.abs().max(value_t(1)); };
+
+            mask_t running = active();
+            while(running.any()) {
+                // Finished lanes take zero-length steps, the others are constrained to the minimum
+                //  step and limited to their end value
+                const lanes_t dv_step = running.select(dv.max(dv_min).min(remaining()), value_t(0));
+                const auto update = m(func, dv_step, result.v, result.y, dv_min);
+                const mask_t accepted = update.accepted && running;
+
+                result.v = accepted.select(result.v + dv_step, result.v);
+                dv = running.select(update.dv_next, dv);
+                result.steps += 1;
+                result.evals += update.evals;
+                result.accepted += accepted.template cast<size_t>();
+                result.rejected += (running && !accepted).template cast<size_t>();
+
+                observer(result.v, result.y, accepted);
+                running = active();
+            }
+
+            return result;
+        }
+
+    protected:
+        value_t dv0;
+        value_t dv_min;
+        method_t method;
+};
+
+} /*namespace batch*/
+} /*namespace epode*/
+
+#endif // EPODE_BATCH_H
@@ -0,0 +1,405 @@
+//
+//
+// File - Epode/bdf.h:
+//
+//      Implementation of a variable-order (1 to 5), variable-step backward differentiation
+//  formula method for large stiff systems, in the Nordsieck form used by LSODE (Hindmarsh,
+//  "ODEPACK, a systematized collection of ODE solvers", 1983) and CVODE.  A step costs a single
+//  (simplified) Newton solve of size N, usually with one to three function evaluations, compared
+//  with the several coupled stage solves of the implicit Runge-Kutta methods.
+//
+//      The history of the solution is kept as the Nordsieck array of scaled derivatives (see
+//  nordsieck.h).  A step predicts the array by Taylor expansion and corrects it with a multiple
+//  of the fixed vector l of the order q formula.  The step size and order are only changed after q + 1
+//  steps at the same order (or after a failure), so that the iteration matrix can be reused.
+//
+//      The Jacobian is reused for up to 50 steps and the iteration matrix is refactored only when
+//  the scale (l1 / dv) has changed by more than 30%, or after 20 steps.  A stale iteration
+//  matrix is compensated by scaling the Newton corrections.  A failed Newton iteration refreshes
+//  the Jacobian before the step size is reduced.
+//
+//
+// License:
+//
+//      This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0.
+//  If a copy of the MPL was not distributed with this file, You can obtain one
+//  at http://mozilla.org/MPL/2.0/.
+//
+//
+
+#ifndef EPODE_BDF_H
+#define EPODE_BDF_H
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <tuple>
+
+#include "core.h"
+#include "dense.h"
+#include "implicit.h"
+#include "nordsieck.h"
+#include "step.h"
+
+namespace epode
+{
+namespace method
+{
+
+// TODO: INCLUDE "ODEPACK, A SYSTEMATIZED COLLECTION OF ODE SOLVERS" (HINDMARSH) IN THE DOCUMENTATION
+//
+// The linear algebra is selected by the Linearization class; use the BDF alias for the dense
+//  default (integrators require methods with exactly two template parameters).
+//
+template<typename Value, size_t N, template<typename V, size_t N2> class Linearization>
+class BasicBDF : public internal::ImplicitAdaptive<Value, 5>
+{
+    public:
+        using value_t = Value;
+        using state_t = internal::State<value_t, N>;
+        using return_t = internal::MethodReturnRef<value_t, state_t>;
+        using linearization_t = Linearization<value_t, N>;
+        using history_t = internal::NordsieckHistory<value_t, N, 5>;
+        using dense_t = typename history_t::dense_t;
+
+        static constexpr size_t max_order = history_t::max_order;
+
+        BasicBDF(const Tolerance<value_t>& _tolerance = internal::defaultTolerance(1e-6, 5))
+            : internal::ImplicitAdaptive<Value, 5>(_tolerance),
+              q(1), q_next(1), steps_at_order(0), v_(0), h(0), h_last(0),
+              have_delta(false), initial(true),
+              jacobian_age(0), factor_age(0), factored_scale(0) {}
+
+        //
+        // Start the history from the initial state: order one, with z[1] = dv*f(v0, y0)
+        //
+        template<typename Funcs>
+        void init(value_t dv, value_t v0, const state_t& y0, Funcs funcs) {
+            restart(std::get<0>(funcs), dv, v0, y0);
+            jacobian_age = std::numeric_limits<size_t>::max();
+            factored_scale = value_t(0);
+        }
+
+        template<typename Funcs, typename Limiter>
+        return_t operator () (Funcs& funcs, value_t dv, value_t v, const state_t& y0, Limiter limiter) {
+            constexpr size_t max_iterations = 3;
+            constexpr size_t jacobian_steps = 50;   // Maximum steps between Jacobian evaluations
+            constexpr size_t factor_steps = 20;     // Maximum steps between factorizations
+            constexpr auto factor_change = value_t(0.3);  // Refactor beyond this relative scale change
+            constexpr auto newton_coefficient = value_t(0.1);
+            constexpr auto divergence = value_t(2);
+            constexpr auto eta_newton = value_t(0.25);   // Step reduction after a Newton failure
+            const auto eps = std::numeric_limits<value_t>::epsilon();
+
+            auto& func = std::get<0>(funcs);
+            size_t evals = 0;
+            size_t jacobians = 0;
+            size_t decompositions = 0;
+            size_t jacobian_evals = 0;
+
+            // The history belongs to the method; it is restarted if the caller moved the state
+            if((v != v_) || (h == value_t(0))) {
+                evals += restart(func, dv, v, y0);
+            }
+
+            // Apply the order and step size selected at the end of the last step
+            q = q_next;
+            auto dv_next = dv;
+            size_t error_failures = 0;
+            size_t newton_failures = 0;
+            size_t newton_iterations = 0;
+            bool done = false;
+
+            do {
+                dv = limiter.constrain(dv_next);
+                if(dv != h) rescale(dv / h);
+
+                // Predict and evaluate the system at the predicted state
+                z.predict(q);
+                coefficients(q, l);
+                const auto scale = l[1] / dv;
+                y = z[0];
+                delta.setZero(y.size());
+                internal::evaluate(func, v + dv, y, f);
+                evals += 1;
+
+                bool jacobian_fresh = false;
+                if(jacobian_age >= jacobian_steps) {
+                    jacobian_evals += linear.jacobian(funcs, v + dv, y, f);
+                    jacobians += 1;
+                    jacobian_age = 0;
+                    jacobian_fresh = true;
+                    factored_scale = value_t(0);
+                }
+
+                // Simplified Newton iteration for the correction, delta = y - z[0]
+                bool converged = false;
+                while(!converged) {
+                    const auto scale_ratio = (factored_scale == value_t(0)) ? value_t(0) : factored_scale / scale;
+                    if((std::abs(scale_ratio - value_t(1)) > factor_change) || (factor_age >= factor_steps)) {
+                        linear.factor(scale);
+                        decompositions += 1;
+                        factored_scale = scale;
+                        factor_age = 0;
+                    }
+                    const auto gamma_ratio = factored_scale / scale;
+                    const auto correction_scale = value_t(2) * gamma_ratio / (value_t(1) + gamma_ratio);
+
+                    const auto tolerance = newton_coefficient * errorTolerance(q);
+                    auto rate = value_t(1);
+                    auto norm_last = value_t(0);
+                    bool diverged = false;
+                    for(size_t iteration = 0; (iteration < max_iterations) && !converged && !diverged; ++iteration) {
+                        newton_iterations += 1;
+                        if(iteration > 0) {
+                            y = z[0] + delta;
+                            internal::evaluate(func, v + dv, y, f);
+                            evals += 1;
+                        }
+                        rhs = f - (z[1] + l[1]*delta) / dv;
+                        linear.solve(rhs, correction);
+                        correction *= correction_scale;
+                        delta += correction;
+
+                        // A correction which is not finite is a divergent iteration
+                        const auto norm = weightedNorm(correction);
+                        diverged = !std::isfinite(norm);
+                        if((iteration > 0) && !diverged) {
+                            rate = std::max(value_t(0.3) * rate, norm / norm_last);
+                            diverged = norm > divergence * norm_last;
+                        }
+                        converged = (norm * std::min(value_t(1), rate)) <= tolerance;
+                        norm_last = std::max(norm, eps);
+                    }
+
+                    // Steps at the minimum are taken regardless, as is a step size which is not a
+                    //  number; a step to a state which is not finite is then failed by the Stepper
+                    if(converged || !(dv > limiter.min)) {
+                        converged = true;
+                    } else if(!jacobian_fresh) {
+                        // Retry the same step from the prediction with a new Jacobian
+                        y = z[0];
+                        delta.setZero(y.size());
+                        internal::evaluate(func, v + dv, y, f);
+                        evals += 1;
+                        jacobian_evals += linear.jacobian(funcs, v + dv, y, f);
+                        jacobians += 1;
+                        jacobian_age = 0;
+                        jacobian_fresh = true;
+                        factored_scale = value_t(0);
+                    } else {
+                        break;
+                    }
+                }
+
+                if(!converged) {
+                    z.retract(q);
+                    newton_failures += 1;
+                    dv_next = dv * eta_newton;
+                    continue;
+                }
+
+                // Local error test
+                const auto error = weightedNorm(delta) / errorCoefficient(q);
+                if(!(error <= this->tolerance.bound()) && (dv > limiter.min)) {
+                    z.retract(q);
+                    error_failures += 1;
+                    if(error_failures >= 3) {
+                        // Repeated failures: restart at first order from the last accepted state
+                        evals += restart(func, dv, v, z[0]);
+                        q = 1;
+                        dv_next = dv * value_t(0.1);
+                    } else {
+                        auto eta = std::isfinite(error) ? stepRatio(error, q + 1, value_t(1.2)) : value_t(0);
+                        if((error_failures > 1) && (q > 1)) {
+                            const auto eta_down = stepRatio(errorLower(), q, value_t(1.3));
+                            if(eta_down > eta) {
+                                q -= 1;
+                                eta = eta_down;
+                            }
+                        }
+                        dv_next = dv * std::max(value_t(0.2), std::min(value_t(0.9), eta));
+                    }
+                    have_delta = false;
+                    steps_at_order = 0;
+                    continue;
+                }
+
+                // Accept the step and update the history with the correction
+                for(size_t j = 0; j <= q; ++j) {
+                    z[j] += l[j] * delta;
+                }
+                done = true;
+            } while(!done);
+
+            v_ = v + dv;
+            h_last = dv;
+            jacobian_age += 1;
+            factor_age += 1;
+            steps_at_order += 1;
+
+            dv_next = dv * selectOrder(error_failures);
+            delta_last = delta;
+            have_delta = (q_next == q);
+
+            return return_t{dv, dv_next, z[0], evals, newton_failures + error_failures, jacobians, decompositions, jacobian_evals,
+                            newton_iterations};
+        }
+
+        // Dense output of the last step from the interpolating polynomial
+        dense_t dense() const {
+            return z.dense(v_, h_last, q);
+        }
+
+        size_t order() const { return q; }
+
+        const linearization_t& linearization() const { return linear; }
+
+    protected:
+        // Coefficients of the order k formula, l(x) = prod_{i=1}^{k} (1 + x/i)
+        static void coefficients(size_t k, std::array<value_t, max_order + 2>& c) {
+            c.fill(value_t(0));
+            c[0] = value_t(1);
+            for(size_t i = 1; i <= k; ++i) {
+                for(size_t j = i; j > 0; --j) {
+                    c[j] += c[j-1] / value_t(i);
+                }
+            }
+        }
+
+        // l1 of the order k formula, the k-th harmonic number
+        static value_t harmonic(size_t k) {
+            auto sum = value_t(0);
+            for(size_t i = 1; i <= k; ++i) sum += value_t(1) / value_t(i);
+            return sum;
+        }
+
+        // The local error of order k is |delta| / ((k+1)*l1)
+        static value_t errorCoefficient(size_t k) {
+            return value_t(k + 1) * harmonic(k);
+        }
+
+        value_t errorTolerance(size_t k) const {
+            return this->tolerance.bound() * errorCoefficient(k);
+        }
+
+        // Local error estimate of the order q-1 formula, from z[q] = dv^q/q! * y^(q)
+        value_t errorLower() const {
+            auto factorial = value_t(1);
+            for(size_t i = 2; i < q; ++i) factorial *= value_t(i);
+            return factorial * weightedNorm(z[q]) / harmonic(q - 1);
+        }
+
+        // Norm of a change of the state, weighted by the current state for relative tolerances
+        template<typename Delta>
+        value_t weightedNorm(const Delta& d) const {
+            return this->tolerance.norm(z[0], z[0], d);
+        }
+
+        // Step ratio for a method with error constant power p, with a safety factor
+        value_t stepRatio(value_t error, size_t p, value_t safety) const {
+            return value_t(1) / (safety * std::pow(error / this->tolerance.bound(), value_t(1) / value_t(p)) + safety*value_t(1e-6));
+        }
+
+        //
+        // Choose the order and step ratio for the next step.  The orders q-1, q and q+1 are
+        //  compared after q+1 steps at the current order; otherwise the step size is kept.
+        //
+        value_t selectOrder(size_t error_failures) {
+            constexpr auto eta_min_change = value_t(1.1);
+            const auto eta_max = initial ? value_t(1e4) : ((error_failures > 0) ? value_t(1) : value_t(10));
+
+            q_next = q;
+            if(steps_at_order <= q) return value_t(1);
+
+            const auto error = weightedNorm(delta) / errorCoefficient(q);
+            auto eta = stepRatio(error, q + 1, value_t(1.2));
+
+            auto eta_down = value_t(0);
+            if(q > 1) eta_down = stepRatio(errorLower(), q, value_t(1.3));
+
+            auto eta_up = value_t(0);
+            if((q < max_order) && have_delta) {
+                const auto error_up = weightedNorm(delta - delta_last) / errorCoefficient(q + 1);
+                eta_up = stepRatio(error_up, q + 2, value_t(1.4));
+            }
+
+            size_t q_new = q;
+            if(eta_down > eta) {
+                eta = eta_down;
+                q_new = q - 1;
+            }
+            if(eta_up > eta) {
+                eta = eta_up;
+                q_new = q + 1;
+            }
+
+            eta = std::min(eta, eta_max);
+            if(eta < eta_min_change) return value_t(1);
+
+            if(q_new > q) {
+                // Estimate the new scaled derivative from the correction
+                z[q + 1] = (l[q] / value_t(q + 1)) * delta;
+            }
+            q_next = q_new;
+            steps_at_order = 0;
+            initial = false;
+            return eta;
+        }
+
+        // Restart the history at first order from (v, y), returning the number of evaluations
+        template<typename Func>
+        size_t restart(Func& func, value_t dv, value_t v, const state_t& y0) {
+            internal::evaluate(func, v, y0, f);
+            z.reset(dv, y0, f);
+            correction.setZero(y0.size());
+            delta_last.setZero(y0.size());
+            q = q_next = 1;
+            steps_at_order = 0;
+            have_delta = false;
+            initial = true;
+            v_ = v;
+            h = dv;
+            h_last = dv;
+            return 1;
+        }
+
+        // Rescale the history for a step ratio eta
+        void rescale(value_t eta) {
+            z.rescale(q, eta);
+            delta_last *= std::pow(eta, value_t(q + 1));
+            h *= eta;
+        }
+
+        size_t q;               // Current order
+        size_t q_next;          // Order of the next step
+        size_t steps_at_order;  // Steps taken since the last order or step size change
+        value_t v_;             // The integration variable at z[0]
+        value_t h;              // The step size of the history scaling
+        value_t h_last;         // The last step taken
+        bool have_delta;        // The last correction was made at the current order
+        bool initial;           // No step size change yet; allow a large first increase
+
+        linearization_t linear;
+        size_t jacobian_age;
+        size_t factor_age;
+        value_t factored_scale;
+
+        std::array<value_t, max_order + 2> l;
+        history_t z;
+        state_t y;
+        state_t f;
+        state_t rhs;
+        state_t delta;
+        state_t delta_last;
+        state_t correction;
+};
+
+template<typename Value, size_t N>
+using BDF = BasicBDF<Value, N, internal::DenseLinearization>;
+
+} /*namespace method*/
+} /*namespace epode*/
+
+#endif // EPODE_BDF_H
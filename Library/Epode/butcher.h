@@ -16,55 +16,40 @@
 #ifndef EPODE_BUTCHERS5TH_H
 #define EPODE_BUTCHERS5TH_H
 
-#include "core.h"
+#include "explicit_rk.h"
 
 namespace epode
 {
-namespace method
+namespace internal
 {
 
-template<typename Value, size_t N>
-class Butcher5th : public internal::Fixed<Value, 5>
+struct Butcher5thTableau
 {
-    public:
-        using value_t = Value;
-        using state_t = internal::State<value_t, N>;
-        using return_t = internal::MethodReturn<value_t, state_t>;
-
-        using internal::Fixed<Value, 5>::Fixed; // Inherit Construtors
+    static constexpr size_t stages = 6;
+    static constexpr size_t order = 5;
+    static constexpr size_t dense_degree = 4;
+    static constexpr Rational c[stages] = {0, {1, 4}, {1, 4}, {1, 2}, {3, 4}, 1};
+    static constexpr Rational a[stages][stages] = {
+        {},
+        {{1, 4}},
+        {{1, 8}, {1, 8}},
+        {0, {-1, 2}, 1},
+        {{3, 16}, 0, 0, {9, 16}},
+        {{-3, 7}, {2, 7}, {12, 7}, {-12, 7}, {8, 7}}
+    };
+    static constexpr Rational b[stages] = {{7, 90}, 0, {32, 90}, {12, 90}, {32, 90}, {7, 90}};
+    static constexpr Rational mid[stages + 1] = {{1, 12}, 0, {1, 3}, {1, 12}, 0, 0, 0};
+};
 
-		template<typename Func, typename Limiter>
-        return_t operator () (Func func, value_t dv, value_t v, state_t y, Limiter) {
-            constexpr auto c0 = value_t(1) / value_t(4);
-            constexpr auto c1 = value_t(1) / value_t(8);
-            constexpr auto c2 = value_t(1) / value_t(2);
-            constexpr auto c3 = value_t(3) / value_t(4);
-            constexpr auto c4 = value_t(3) / value_t(16);
-            constexpr auto c5 = value_t(9) / value_t(16);
-            constexpr auto c6 = value_t(-3) / value_t(7);
-            constexpr auto c7 = value_t(2) / value_t(7);
-            constexpr auto c8 = value_t(12) / value_t(7);
-            constexpr auto c9 = value_t(8) / value_t(7);
-            constexpr auto c10 = value_t(1) / value_t(90);
-            constexpr auto c11 = value_t(7);
-            constexpr auto c12 = value_t(32);
-            constexpr auto c13 = value_t(12);
+} /*namespace internal*/
 
-            const auto k0 = func(v, y);
-            const auto k1 = func(v+(c0*dv), y+(c0*dv*k0));
-            const auto k2 = func(v+(c0*dv), y+(c1*dv*(k0 + k1)));
-            const auto k3 = func(v+(c2*dv), y+(dv*(k2 - c2*k1)));
-            const auto k4 = func(v+(c3*dv), y+(dv*(c4*k0 + c5*k3)));
-            const auto k5 = func(v+dv, y+(dv*(c6*k0 + c7*k1 + (c8*(k2-k3)) + c9*k4)));
+namespace method
+{
 
-            return return_t{dv, dv, y + (dv * c10 * (c11*(k0+k5) + c12*(k2 + k4) + c13*k3)), 6};
-        }
-};
+template<typename Value, size_t N>
+using Butcher5th = ExplicitRK<Value, N, internal::Butcher5thTableau>;
 
 } /*namespace method*/
 } /*namespace epode*/
 
 #endif // EPODE_BUTCHERS5TH_H
-
-
-
@@ -19,26 +19,129 @@
 #define CORE
 
 #include <tuple>
+#include <type_traits>
 
 #include <Eigen/Dense>
 
+#include "step.h"
+
 namespace epode
 {
 
-// Wrap a number of functions in a tuple of functions
+// Wrap a number of functions in a tuple of functions.  The first is the system function; the
+//  implicit methods also use a Jacobian function and/or a sparsity pattern, as fns(f, jac),
+//  fns(f, jac, pattern) or fns(f, pattern) (see implicit.h and sparse.h).
 //  TODO: THIS NEEDS TO VALIDATE THE FUNCTION ARGUMENTS
 template<typename... Ts>
 auto fns(Ts&&... _args) { return std::make_tuple(_args...); }
 
+//
+// The state size used for systems whose size is only known at runtime.  States of this size are
+//  heap allocated Eigen vectors; the methods size their stage buffers from the initial state and
+//  reuse them for every step.  System functions for large states should take the state by const
+//  reference (not by value or auto) to avoid a copy per evaluation.
+//
+constexpr size_t Dynamic = static_cast<size_t>(-1);
+
+//
+// The reason that an integration ended.  The exit status of an integration is stored in the
+//  statistics of its last result; Running marks the statistics of the earlier results.
+//
+enum class Status
+{
+    Running,
+    Completed,      // The end trigger fired
+    Event,          // A terminating event occurred (see events.h)
+    TimeLimit,      // The wall-clock budget was exhausted (see triggers.h)
+    EvalLimit,      // The system evaluation budget was exhausted
+    RejectLimit,    // Too many steps were rejected
+    StepLimit,      // The step size fell below its floor
+    Diverged        // The step size or the state became non-finite (see Stepper::step())
+};
+
+//
+// Error tolerance of the adaptive methods.  A single value is an absolute tolerance on the
+//  Euclidean norm of the error estimate.  Absolute and relative tolerances, each either a scalar
+//  or one per state component, use the weighted RMS norm of Hairer and Wanner,
+//
+//      |e| = sqrt(1/n * sum_i (e_i / sc_i)^2),    sc_i = atol_i + rtol_i * max(|y0_i|, |y1_i|)
+//
+//  which is compared against one.  The methods compare norm() against bound() in either case.
+//
+// TODO: INCLUDE "SOLVING ORDINARY DIFFERENTIAL EQUATIONS I" (HAIRER, NORSETT, WANNER) IN THE DOCUMENTATION
+template<typename Value>
+class Tolerance
+{
+    public:
+        using value_t = Value;
+        using values_t = Eigen::Array<value_t, 1, Eigen::Dynamic>;
+
+        Tolerance(const value_t& _tolerance)
+            : weighted(false), tolerance(_tolerance), atol(1), rtol(1) {
+            atol(0) = _tolerance;
+            rtol(0) = value_t(0);
+        }
+
+        Tolerance(const value_t& _atol, const value_t& _rtol)
+            : weighted(true), tolerance(1), atol(1), rtol(1) {
+            atol(0) = _atol;
+            rtol(0) = _rtol;
+        }
+
+        template<typename ATol, typename RTol>
+        Tolerance(const Eigen::DenseBase<ATol>& _atol, const Eigen::DenseBase<RTol>& _rtol)
+            : weighted(true), tolerance(1), atol(_atol.size()), rtol(_rtol.size()) {
+            for(Eigen::Index i = 0; i < _atol.size(); ++i) atol(i) = _atol.derived()(i);
+            for(Eigen::Index i = 0; i < _rtol.size(); ++i) rtol(i) = _rtol.derived()(i);
+        }
+
+        // The norm of the error estimate, delta, of a step from y0 to y1
+        template<typename Y0, typename Y1, typename Delta>
+        value_t norm(const Y0& y0, const Y1& y1, const Delta& delta) const {
+            using std::abs;
+            using std::max;
+            using std::sqrt;
+            if(!weighted) return delta.norm();
+
+            auto sum = value_t(0);
+            const auto n = delta.size();
+            for(Eigen::Index i = 0; i < n; ++i) {
+                const auto sc = atol((atol.size() == 1) ? 0 : i) +
+                        rtol((rtol.size() == 1) ? 0 : i) * max(abs(y0(i)), abs(y1(i)));
+                const auto e = delta(i) / sc;
+                sum += e*e;
+            }
+            return sqrt(sum / value_t(n));
+        }
+
+        // The bound on the error norm of an accepted step
+        value_t bound() const { return tolerance; }
+
+    protected:
+        bool weighted;
+        value_t tolerance;
+        values_t atol;
+        values_t rtol;
+};
+
 namespace internal
 {
+constexpr int stateColumns(size_t N) {
+    return (N == Dynamic) ? Eigen::Dynamic : static_cast<int>(N);
+}
+
+constexpr size_t stateSize(int Columns) {
+    return (Columns == Eigen::Dynamic) ? Dynamic : static_cast<size_t>(Columns);
+}
+
 template<typename Value, size_t N>
-using State = Eigen::Matrix<Value, 1, N>;
+using State = Eigen::Matrix<Value, 1, stateColumns(N)>;
 
-template<typename Value, size_t _N>
+template<typename Value, int Columns>
 struct StateProperties {
         using value_t = Value;
-        static constexpr size_t N = static_cast<size_t>(_N);
+        static constexpr size_t N = stateSize(Columns);
+        static constexpr bool dynamic = (N == Dynamic);
 };
 
 
@@ -64,15 +167,77 @@ struct MethodReturn
         using value_t = Value;
         using state_t = State;
 
-        MethodReturn(value_t _dv, value_t _dv_next, state_t _y, size_t _evals)
-            : dv(_dv), dv_next(_dv_next), y(_y), evals(_evals) {}
+        MethodReturn(value_t _dv, value_t _dv_next, state_t _y, size_t _evals, size_t _rejected = 0,
+                     size_t _jacobians = 0, size_t _decompositions = 0, size_t _jacobian_evals = 0,
+                     size_t _iterations = 0)
+            : dv(_dv), dv_next(_dv_next), y(_y), evals(_evals), rejected(_rejected),
+              jacobians(_jacobians), decompositions(_decompositions), jacobian_evals(_jacobian_evals),
+              iterations(_iterations) {}
 
         value_t dv;
         value_t dv_next;
         state_t y;
         size_t evals;
+        size_t rejected;        // Rejected attempts before the step was accepted
+        size_t jacobians;       // Jacobian evaluations (implicit methods)
+        size_t decompositions;  // Matrix factorizations (implicit methods)
+        size_t jacobian_evals;  // System evaluations for finite difference and automatic Jacobians (not in evals)
+        size_t iterations;      // Newton iterations (implicit methods)
 };
 
+//
+// Methods which keep the new state in a member buffer return a reference to it.  The stepper
+//  copies the state into its own (already sized) storage, so stepping does not allocate.
+//
+template<typename Value, typename State>
+using MethodReturnRef = MethodReturn<Value, const State&>;
+
+//
+// Evaluate the system function into caller storage.  The system function may either return the
+//  derivative, f(v, y), or write it into its third argument, f(v, y, dydt).  The second form is
+//  preferred when both are available as it allows large systems to be stepped without any
+//  allocation.  An in-place function is always passed a derivative of the size of the state, so
+//  it may assign its elements directly; with Dynamic states the first evaluations into each
+//  buffer size it (and allocate), later evaluations do not.
+//
+template<typename YState, typename DState>
+void sizeDerivative(const YState& y, DState& dydt, std::true_type) {
+    if(dydt.size() != y.size()) dydt.resize(y.size());
+}
+
+// Jacobians (and other non-vector outputs) are sized by their callers
+template<typename YState, typename DState>
+void sizeDerivative(const YState&, DState&, std::false_type) {}
+
+template<typename Func, typename Value, typename YState, typename DState>
+auto evaluateImpl(Func& func, const Value& v, const YState& y, DState& dydt, int)
+-> decltype(func(v, y, dydt), void()) {
+    sizeDerivative(y, dydt, std::integral_constant<bool, DState::IsVectorAtCompileTime != 0>{});
+    func(v, y, dydt);
+}
+
+template<typename Func, typename Value, typename YState, typename DState>
+auto evaluateImpl(Func& func, const Value& v, const YState& y, DState& dydt, long)
+-> decltype(dydt = func(v, y), void()) {
+    dydt = func(v, y);
+}
+
+template<typename Func, typename Value, typename YState, typename DState>
+void evaluate(Func& func, const Value& v, const YState& y, DState& dydt) {
+    evaluateImpl(func, v, y, dydt, 0);
+}
+
+// The derivative type of a system function for a given initial state
+template<typename Func, typename Value, typename YState>
+auto systemResult(Func& func, const Value& v, const YState& y, int) -> decltype(func(v, y)) {
+    return func(v, y);
+}
+
+template<typename Func, typename Value, typename YState>
+YState systemResult(Func&, const Value&, const YState& y, long) {
+    return y;
+}
+
 template<typename Value, typename State, typename Stats>
 struct StepPoint
 {
@@ -112,11 +277,15 @@ using ImplicitFixed = Fixed<Value, Order, true>;
 template<typename Value, size_t Order, bool Implicit = false>
 class Adaptive : public MethodInfo<Value, true, Implicit, Order> {
     public:
-        Adaptive(const Value& _tolerance = defaultTolerance(1e-6, Order)) :
-            tolerance(_tolerance) {}
+        Adaptive(const Tolerance<Value>& _tolerance = defaultTolerance(1e-6, Order),
+                 const step::Controller<Value>& _controller = step::Controller<Value>()) :
+            tolerance(_tolerance), controller(_controller) {}
+
+        const Tolerance<Value>& stepTolerance() const { return tolerance; }
 
     protected:
-        Value tolerance;
+        Tolerance<Value> tolerance;
+        step::Controller<Value> controller;
 };
 
 template<typename Value, size_t Order>
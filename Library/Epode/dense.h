@@ -0,0 +1,167 @@
+//
+//
+// File - Epode/dense.h:
+//
+//      Polynomial continuous extensions (dense output) of a single integration step.  Methods
+//  which support dense output build one of these interpolants from data they already have at
+//  the end of a step -- the state and derivative at each end of the step and, for the higher
+//  order methods, a midpoint value formed from the existing stages -- so evaluating the
+//  interpolant never requires an additional call of the system function.  The exception is the
+//  seventh-order interpolant of DOP853, which needs three more stages; these are only evaluated
+//  when the interpolant is built.
+//
+//
+// License:
+//
+//      This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0.
+//  If a copy of the MPL was not distributed with this file, You can obtain one
+//  at http://mozilla.org/MPL/2.0/.
+//
+//
+
+#ifndef EPODE_DENSE_H
+#define EPODE_DENSE_H
+
+#include <array>
+#include <type_traits>
+#include <utility>
+
+#include "core.h"
+
+namespace epode
+{
+namespace internal
+{
+
+//
+// A polynomial in the normalized step variable, theta = (v - v0) / dv, stored in Horner form
+//  as y(theta) = y0 + theta*(r[0] + theta*(r[1] + ...)).  Evaluation is O(N) in the state size.
+//
+template<typename Value, typename State, size_t Degree>
+class DenseOutput
+{
+    public:
+        using value_t = Value;
+        using state_t = State;
+
+        DenseOutput(value_t _v0, value_t _dv, const state_t& _y0)
+            : v0(_v0), dv(_dv), y0(_y0) {}
+
+        state_t operator() (value_t v) const {
+            const auto theta = (v - v0) / dv;
+            state_t y = r[Degree-1];
+            for(size_t idx = Degree-1; idx > 0; --idx) {
+                y = r[idx-1] + theta*y;
+            }
+            return y0 + theta*y;
+        }
+
+        value_t begin() const { return v0; }
+        value_t end() const { return v0 + dv; }
+
+        value_t v0;
+        value_t dv;
+        state_t y0;
+        std::array<state_t, Degree> r;
+};
+
+//
+// Cubic Hermite interpolant from the state and derivative at both ends of the step.  This is a
+//  third-order continuous extension.
+//
+template<typename Value, typename State>
+DenseOutput<Value, State, 3> hermiteCubic(
+        Value v0, Value dv,
+        const State& y0, const State& f0,
+        const State& y1, const State& f1) {
+    auto dense = DenseOutput<Value, State, 3>(v0, dv, y0);
+    const State d = y1 - y0;
+    dense.r[0] = dv*f0;
+    dense.r[1] = Value(3)*d - dv*(Value(2)*f0 + f1);
+    dense.r[2] = dv*(f0 + f1) - Value(2)*d;
+    return dense;
+}
+
+//
+// Quartic interpolant from the state and derivative at both ends of the step and a midpoint
+//  value.  When the midpoint value is (at least) fourth-order accurate, this is a fourth-order
+//  continuous extension.
+//
+template<typename Value, typename State>
+DenseOutput<Value, State, 4> hermiteQuartic(
+        Value v0, Value dv,
+        const State& y0, const State& f0,
+        const State& y1, const State& f1,
+        const State& y_half) {
+    auto dense = DenseOutput<Value, State, 4>(v0, dv, y0);
+    dense.r[0] = dv*f0;
+    const State d1 = y1 - y0 - dense.r[0];
+    const State d2 = dv*f1 - dense.r[0];
+    const State d3 = y_half - y0 - dense.r[0]/Value(2);
+    dense.r[1] = Value(-5)*d1 + d2 + Value(16)*d3;
+    dense.r[2] = Value(14)*d1 - Value(3)*d2 - Value(32)*d3;
+    dense.r[3] = Value(-8)*d1 + Value(2)*d2 + Value(16)*d3;
+    return dense;
+}
+
+//
+// Convert a continuous extension in the nested form of the Dormand-Prince codes of Hairer,
+//  y(theta) = y0 + theta*(F[0] + (1-theta)*(F[1] + theta*(F[2] + (1-theta)*(F[3] + ...)))),
+//  to the Horner form.
+//
+template<typename Value, typename State, size_t Degree>
+DenseOutput<Value, State, Degree> nestedDense(
+        Value v0, Value dv, const State& y0, const std::array<State, Degree>& F) {
+    auto dense = DenseOutput<Value, State, Degree>(v0, dv, y0);
+    dense.r[0] = F[Degree-1];
+    for(size_t k = 1; k < Degree; ++k) {
+        dense.r[k].setZero(y0.size());
+    }
+
+    // Expand from the innermost bracket, multiplying by theta or (1-theta) in turn
+    for(size_t i = Degree-1, degree = 0; i > 0; --i, ++degree) {
+        if(((i-1) % 2) == 0) {
+            for(size_t k = degree+1; k > 0; --k) dense.r[k] -= dense.r[k-1];
+        } else {
+            for(size_t k = degree+1; k > 0; --k) dense.r[k] = dense.r[k-1];
+            dense.r[0].setZero(y0.size());
+        }
+        dense.r[0] += F[i-1];
+    }
+    return dense;
+}
+
+//
+// Detect whether a method object provides dense output for its last step.  Such methods name
+//  their interpolant type, dense_t, and build it either from the data of the step alone,
+//  dense(), or with further evaluations of the system, dense(funcs).
+//
+template<typename Method, typename = void>
+struct hasDenseOutput : std::false_type {};
+
+template<typename Method>
+struct hasDenseOutput<Method, decltype(std::declval<typename Method::dense_t>(), void())>
+    : std::true_type {};
+
+// The system evaluations made by dense(funcs) to build the interpolant, dense_evals if named
+template<typename Method, typename = void>
+struct denseEvaluations : std::integral_constant<size_t, 0> {};
+
+template<typename Method>
+struct denseEvaluations<Method, decltype(Method::dense_evals, void())>
+    : std::integral_constant<size_t, Method::dense_evals> {};
+
+template<typename Method, typename Funcs>
+auto denseOutput(const Method& method, const Funcs&) -> decltype(method.dense()) {
+    return method.dense();
+}
+
+template<typename Method, typename Funcs>
+auto denseOutput(const Method& method, const Funcs& funcs) -> decltype(method.dense(funcs)) {
+    return method.dense(funcs);
+}
+
+} /*namespace internal*/
+} /*namespace epode*/
+
+#endif // EPODE_DENSE_H
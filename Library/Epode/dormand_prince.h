@@ -0,0 +1,695 @@
+//
+//
+// File - Epode/dormand_prince.h:
+//
+//      Implementation of the Dormand-Prince 5(4) method and of the 8(5,3) method DOP853 of
+//  Hairer, Norsett and Wanner ("Solving Ordinary Differential Equations I", 1993), with the
+//  coefficients, error estimates, continuous extensions and stiffness detection of their DOPRI5
+//  and DOP853 codes.  Both methods have the FSAL (First Same As Last) property, so an accepted
+//  step costs six (DP45) or twelve (DOP853) evaluations of the system function.  DOP853 is the
+//  method of choice at tolerances below about 1e-8.
+//
+//      Both methods test for stiffness after every accepted step by estimating dv*|lambda| from
+//  the last two stages, which are evaluated at the same value of the integration variable.
+//  When the estimate is beyond the stability boundary of the method for 15 steps (with fewer
+//  than six steps in between), stiff() becomes true; an implicit method will then be more
+//  efficient.
+//
+//
+// License:
+//
+//      This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0.
+//  If a copy of the MPL was not distributed with this file, You can obtain one
+//  at http://mozilla.org/MPL/2.0/.
+//
+//
+
+#ifndef EPODE_DORMAND_PRINCE_H
+#define EPODE_DORMAND_PRINCE_H
+
+#include <array>
+#include <cmath>
+
+#include "core.h"
+#include "dense.h"
+#include "step.h"
+
+namespace epode
+{
+namespace internal
+{
+
+//
+// Stiffness detection of the Dormand-Prince codes, from the stability boundary of the method
+//  along the negative real axis.
+//
+template<typename Value>
+class StiffnessDetector
+{
+    public:
+        using value_t = Value;
+
+        explicit StiffnessDetector(value_t _boundary)
+            : boundary(_boundary), ratio_(0), stiff_steps(0), nonstiff_steps(0) {}
+
+        // Update from the difference of two stages (df) and of their arguments (dy)
+        template<typename DF, typename DY>
+        void update(value_t dv, const DF& df, const DY& dy) {
+            const auto den = dy.norm();
+            ratio_ = (den > value_t(0)) ? std::abs(dv) * df.norm() / (den * boundary) : value_t(0);
+            if(ratio_ > value_t(1)) {
+                nonstiff_steps = 0;
+                stiff_steps += 1;
+            } else {
+                nonstiff_steps += 1;
+                if(nonstiff_steps == 6) stiff_steps = 0;
+            }
+        }
+
+        // The estimate of dv*|lambda| relative to the stability boundary in the last step
+        value_t ratio() const { return ratio_; }
+
+        bool stiff() const { return stiff_steps >= 15; }
+
+    protected:
+        value_t boundary;
+        value_t ratio_;
+        size_t stiff_steps;
+        size_t nonstiff_steps;
+};
+
+//
+// Coefficients of DOP853, including the three extra stages of the dense output.  The strictly
+//  lower triangular a matrix is stored by rows; row 12 holds the weights of the solution, whose
+//  derivative is stage 12 of the next step.
+//
+template<typename Value>
+struct DOP853Coefficients
+{
+        using value_t = Value;
+
+        static constexpr size_t index(size_t i, size_t j) { return ((i*(i-1))/2) + j; }
+
+        static constexpr std::array<value_t, 16> c = {{
+            value_t(0),
+            value_t(0.526001519587677318785587544488e-01),
+            value_t(0.789002279381515978178381316732e-01),
+            value_t(0.118350341907227396726757197510),
+            value_t(0.281649658092772603273242802490),
+            value_t(0.333333333333333333333333333333),
+            value_t(0.25),
+            value_t(0.307692307692307692307692307692),
+            value_t(0.651282051282051282051282051282),
+            value_t(0.6),
+            value_t(0.857142857142857142857142857142),
+            value_t(1.0),
+            value_t(1.0),
+            value_t(0.1),
+            value_t(0.2),
+            value_t(0.777777777777777777777777777778)
+        }};
+
+        static constexpr std::array<value_t, 120> a = {{
+            // Stage 1
+            value_t(5.26001519587677318785587544488e-2),
+            // Stage 2
+            value_t(1.97250569845378994544595329183e-2),
+            value_t(5.91751709536136983633785987549e-2),
+            // Stage 3
+            value_t(2.95875854768068491816892993775e-2),
+            value_t(0),
+            value_t(8.87627564304205475450678981324e-2),
+            // Stage 4
+            value_t(2.41365134159266685502369798665e-1),
+            value_t(0),
+            value_t(-8.84549479328286085344864962717e-1),
+            value_t(9.24834003261792003115737966543e-1),
+            // Stage 5
+            value_t(3.7037037037037037037037037037e-2),
+            value_t(0),
+            value_t(0),
+            value_t(1.70828608729473871279604482173e-1),
+            value_t(1.25467687566822425016691814123e-1),
+            // Stage 6
+            value_t(3.7109375e-2),
+            value_t(0),
+            value_t(0),
+            value_t(1.70252211019544039314978060272e-1),
+            value_t(6.02165389804559606850219397283e-2),
+            value_t(-1.7578125e-2),
+            // Stage 7
+            value_t(3.70920001185047927108779319836e-2),
+            value_t(0),
+            value_t(0),
+            value_t(1.70383925712239993810214054705e-1),
+            value_t(1.07262030446373284651809199168e-1),
+            value_t(-1.53194377486244017527936158236e-2),
+            value_t(8.27378916381402288758473766002e-3),
+            // Stage 8
+            value_t(6.24110958716075717114429577812e-1),
+            value_t(0),
+            value_t(0),
+            value_t(-3.36089262944694129406857109825),
+            value_t(-8.68219346841726006818189891453e-1),
+            value_t(2.75920996994467083049415600797e1),
+            value_t(2.01540675504778934086186788979e1),
+            value_t(-4.34898841810699588477366255144e1),
+            // Stage 9
+            value_t(4.77662536438264365890433908527e-1),
+            value_t(0),
+            value_t(0),
+            value_t(-2.48811461997166764192642586468),
+            value_t(-5.90290826836842996371446475743e-1),
+            value_t(2.12300514481811942347288949897e1),
+            value_t(1.52792336328824235832596922938e1),
+            value_t(-3.32882109689848629194453265587e1),
+            value_t(-2.03312017085086261358222928593e-2),
+            // Stage 10
+            value_t(-9.3714243008598732571704021658e-1),
+            value_t(0),
+            value_t(0),
+            value_t(5.18637242884406370830023853209),
+            value_t(1.09143734899672957818500254654),
+            value_t(-8.14978701074692612513997267357),
+            value_t(-1.85200656599969598641566180701e1),
+            value_t(2.27394870993505042818970056734e1),
+            value_t(2.49360555267965238987089396762),
+            value_t(-3.0467644718982195003823669022),
+            // Stage 11
+            value_t(2.27331014751653820792359768449),
+            value_t(0),
+            value_t(0),
+            value_t(-1.05344954667372501984066689879e1),
+            value_t(-2.00087205822486249909675718444),
+            value_t(-1.79589318631187989172765950534e1),
+            value_t(2.79488845294199600508499808837e1),
+            value_t(-2.85899827713502369474065508674),
+            value_t(-8.87285693353062954433549289258),
+            value_t(1.23605671757943030647266201528e1),
+            value_t(6.43392746015763530355970484046e-1),
+            // Weights of the eighth-order solution
+            value_t(5.42937341165687622380535766363e-2),
+            value_t(0),
+            value_t(0),
+            value_t(0),
+            value_t(0),
+            value_t(4.45031289275240888144113950566),
+            value_t(1.89151789931450038304281599044),
+            value_t(-5.8012039600105847814672114227),
+            value_t(3.1116436695781989440891606237e-1),
+            value_t(-1.52160949662516078556178806805e-1),
+            value_t(2.01365400804030348374776537501e-1),
+            value_t(4.47106157277725905176885569043e-2),
+            // Stage 13 (dense output)
+            value_t(5.61675022830479523392909219681e-2),
+            value_t(0),
+            value_t(0),
+            value_t(0),
+            value_t(0),
+            value_t(0),
+            value_t(2.53500210216624811088794765333e-1),
+            value_t(-2.46239037470802489917441475441e-1),
+            value_t(-1.24191423263816360469010140626e-1),
+            value_t(1.5329179827876569731206322685e-1),
+            value_t(8.20105229563468988491666602057e-3),
+            value_t(7.56789766054569976138603589584e-3),
+            value_t(-8.298e-3),
+            // Stage 14 (dense output)
+            value_t(3.18346481635021405060768473261e-2),
+            value_t(0),
+            value_t(0),
+            value_t(0),
+            value_t(0),
+            value_t(2.83009096723667755288322961402e-2),
+            value_t(5.35419883074385676223797384372e-2),
+            value_t(-5.49237485713909884646569340306e-2),
+            value_t(0),
+            value_t(0),
+            value_t(-1.08347328697249322858509316994e-4),
+            value_t(3.82571090835658412954920192323e-4),
+            value_t(-3.40465008687404560802977114492e-4),
+            value_t(1.41312443674632500278074618366e-1),
+            // Stage 15 (dense output)
+            value_t(-4.28896301583791923408573538692e-1),
+            value_t(0),
+            value_t(0),
+            value_t(0),
+            value_t(0),
+            value_t(-4.69762141536116384314449447206),
+            value_t(7.68342119606259904184240953878),
+            value_t(4.06898981839711007970213554331),
+            value_t(3.56727187455281109270669543021e-1),
+            value_t(0),
+            value_t(0),
+            value_t(0),
+            value_t(-1.39902416515901462129418009734e-3),
+            value_t(2.9475147891527723389556272149),
+            value_t(-9.15095847217987001081870187138)
+        }};
+
+        // Coefficients of the fifth and third order error estimates
+        static constexpr std::array<value_t, 12> e5 = {{
+            value_t(0.1312004499419488073250102996e-1),
+            value_t(0),
+            value_t(0),
+            value_t(0),
+            value_t(0),
+            value_t(-0.1225156446376204440720569753e1),
+            value_t(-0.4957589496572501915214079952),
+            value_t(0.1664377182454986536961530415e1),
+            value_t(-0.3503288487499736816886487290),
+            value_t(0.3341791187130174790297318841),
+            value_t(0.8192320648511571246570742613e-1),
+            value_t(-0.2235530786388629525884427845e-1)
+        }};
+
+        static constexpr std::array<value_t, 12> e3 = {{
+            value_t(-1.89800754072407615714702328876e-1),
+            value_t(0),
+            value_t(0),
+            value_t(0),
+            value_t(0),
+            value_t(4.45031289275240888144113950566e+0),
+            value_t(1.89151789931450038304281599044e+0),
+            value_t(-5.80120396001058478146721142270e+0),
+            value_t(-4.22682321323791962932445679177e-1),
+            value_t(-1.52160949662516078556178806805e-1),
+            value_t(2.01365400804030348374776537501e-1),
+            value_t(2.26517921983608258118062039631e-2)
+        }};
+
+        // Coefficients of the dense output
+        static constexpr std::array<std::array<value_t, 16>, 4> d = {{
+            {{
+                value_t(-0.84289382761090128651353491142e1),
+                value_t(0),
+                value_t(0),
+                value_t(0),
+                value_t(0),
+                value_t(0.56671495351937776962531783590),
+                value_t(-0.30689499459498916912797304727e1),
+                value_t(0.23846676565120698287728149680e1),
+                value_t(0.21170345824450282767155149946e1),
+                value_t(-0.87139158377797299206789907490),
+                value_t(0.22404374302607882758541771650e1),
+                value_t(0.63157877876946881815570249290),
+                value_t(-0.88990336451333310820698117400e-1),
+                value_t(0.18148505520854727256656404962e2),
+                value_t(-0.91946323924783554000451984436e1),
+                value_t(-0.44360363875948939664310572000e1)
+            }},
+            {{
+                value_t(0.10427508642579134603413151009e2),
+                value_t(0),
+                value_t(0),
+                value_t(0),
+                value_t(0),
+                value_t(0.24228349177525818288430175319e3),
+                value_t(0.16520045171727028198505394887e3),
+                value_t(-0.37454675472269020279518312152e3),
+                value_t(-0.22113666853125306036270938578e2),
+                value_t(0.77334326684722638389603898808e1),
+                value_t(-0.30674084731089398182061213626e2),
+                value_t(-0.93321305264302278729567221706e1),
+                value_t(0.15697238121770843886131091075e2),
+                value_t(-0.31139403219565177677282850411e2),
+                value_t(-0.93529243588444783865713862664e1),
+                value_t(0.35816841486394083752465898540e2)
+            }},
+            {{
+                value_t(0.19985053242002433820987653617e2),
+                value_t(0),
+                value_t(0),
+                value_t(0),
+                value_t(0),
+                value_t(-0.38703730874935176555105901742e3),
+                value_t(-0.18917813819516756882830838328e3),
+                value_t(0.52780815920542364900561016686e3),
+                value_t(-0.11573902539959630126141871134e2),
+                value_t(0.68812326946963000169666922661e1),
+                value_t(-0.10006050966910838403183860980e1),
+                value_t(0.77771377980534432092869265740),
+                value_t(-0.27782057523535084065932004339e1),
+                value_t(-0.60196695231264120758267380846e2),
+                value_t(0.84320405506677161018159903784e2),
+                value_t(0.11992291136182789328035130030e2)
+            }},
+            {{
+                value_t(-0.25693933462703749003312586129e2),
+                value_t(0),
+                value_t(0),
+                value_t(0),
+                value_t(0),
+                value_t(-0.15418974869023643374053993627e3),
+                value_t(-0.23152937917604549567536039109e3),
+                value_t(0.35763911791061412378285349910e3),
+                value_t(0.93405324183624310003907691704e2),
+                value_t(-0.37458323136451633156875139351e2),
+                value_t(0.10409964950896230045147246184e3),
+                value_t(0.29840293426660503123344363579e2),
+                value_t(-0.43533456590011143754432175058e2),
+                value_t(0.96324553959188282948394950600e2),
+                value_t(-0.39177261675615439165231486172e2),
+                value_t(-0.14972683625798562581422125276e3)
+            }}
+        }};
+};
+
+template<typename Value> constexpr std::array<Value, 16> DOP853Coefficients<Value>::c;
+template<typename Value> constexpr std::array<Value, 120> DOP853Coefficients<Value>::a;
+template<typename Value> constexpr std::array<Value, 12> DOP853Coefficients<Value>::e5;
+template<typename Value> constexpr std::array<Value, 12> DOP853Coefficients<Value>::e3;
+template<typename Value> constexpr std::array<std::array<Value, 16>, 4> DOP853Coefficients<Value>::d;
+
+} /*namespace internal*/
+
+namespace method
+{
+
+// TODO: INCLUDE "A FAMILY OF EMBEDDED RUNGE-KUTTA FORMULAE" (DORMAND AND PRINCE) IN THE DOCUMENTATION
+template<typename Value, size_t N>
+class DP45 : public internal::Adaptive<Value, 4>
+{
+    public:
+        using value_t = Value;
+        using state_t = internal::State<value_t, N>;
+        using return_t = internal::MethodReturnRef<value_t, state_t>;
+        using dense_t = internal::DenseOutput<value_t, state_t, 4>;
+
+        DP45(const Tolerance<value_t>& _tolerance = internal::defaultTolerance(1e-6, 4),
+             const step::Controller<value_t>& _controller = defaultController())
+            : internal::Adaptive<Value, 4>(_tolerance, _controller), v_(0), v0_(0), dv_(0), detector(value_t(3.25)) {
+            for(auto buffer : {&k0, &k1, &k2, &k3, &k4, &k5, &k6, &ys, &z1, &y0_, &y1_}) buffer->setZero();
+        }
+
+        //
+        // The step size controller of DOPRI5: the PI controller with beta = 0.04, (tolerance /
+        //  error)^0.17 * (last tolerance / error)^-0.04, a safety factor of 0.9 and the step scaled
+        //  within [0.2, 10]
+        //
+        static step::Controller<value_t> defaultController() {
+            return step::Controller<value_t>(value_t(0.85), value_t(-0.2), value_t(0), value_t(0.9), value_t(0.2), value_t(10));
+        }
+
+        template<typename Func>
+        void init(value_t /*dv*/, value_t v0, const state_t& y0, Func func) {
+            internal::evaluate(func, v0, y0, k0);
+            this->controller.reset();
+            v_ = v0;
+            y1_ = y0;
+            v0_ = v0;
+            dv_ = value_t(0);
+        }
+
+        template<typename Func, typename Limiter>
+        return_t operator () (Func func, value_t dv, value_t v, const state_t& y0, Limiter limiter) {
+            constexpr auto c2 = value_t(1) / value_t(5);
+            constexpr auto c3 = value_t(3) / value_t(10);
+            constexpr auto c4 = value_t(4) / value_t(5);
+            constexpr auto c5 = value_t(8) / value_t(9);
+            constexpr auto a21 = value_t(1) / value_t(5);
+            constexpr auto a31 = value_t(3) / value_t(40);
+            constexpr auto a32 = value_t(9) / value_t(40);
+            constexpr auto a41 = value_t(44) / value_t(45);
+            constexpr auto a42 = value_t(-56) / value_t(15);
+            constexpr auto a43 = value_t(32) / value_t(9);
+            constexpr auto a51 = value_t(19372) / value_t(6561);
+            constexpr auto a52 = value_t(-25360) / value_t(2187);
+            constexpr auto a53 = value_t(64448) / value_t(6561);
+            constexpr auto a54 = value_t(-212) / value_t(729);
+            constexpr auto a61 = value_t(9017) / value_t(3168);
+            constexpr auto a62 = value_t(-355) / value_t(33);
+            constexpr auto a63 = value_t(46732) / value_t(5247);
+            constexpr auto a64 = value_t(49) / value_t(176);
+            constexpr auto a65 = value_t(-5103) / value_t(18656);
+            constexpr auto b1 = value_t(35) / value_t(384);
+            constexpr auto b3 = value_t(500) / value_t(1113);
+            constexpr auto b4 = value_t(125) / value_t(192);
+            constexpr auto b5 = value_t(-2187) / value_t(6784);
+            constexpr auto b6 = value_t(11) / value_t(84);
+            constexpr auto e1 = value_t(71) / value_t(57600);
+            constexpr auto e3 = value_t(-71) / value_t(16695);
+            constexpr auto e4 = value_t(71) / value_t(1920);
+            constexpr auto e5 = value_t(-17253) / value_t(339200);
+            constexpr auto e6 = value_t(22) / value_t(525);
+            constexpr auto e7 = value_t(-1) / value_t(40);
+
+            size_t evals = 0;
+            size_t rejected = 0;
+
+            // The first stage is carried over from the last step unless the state was moved
+            if((v != v_) || (y0 != y1_)) {
+                internal::evaluate(func, v, y0, k0);
+                evals += 1;
+            }
+
+            auto dv_next = dv;
+            bool done = false;
+
+            do {
+                dv = limiter.constrain(dv_next);
+                ys = y0 + (dv*a21)*k0;
+                internal::evaluate(func, v+(c2*dv), ys, k1);
+                ys = y0 + dv*(a31*k0 + a32*k1);
+                internal::evaluate(func, v+(c3*dv), ys, k2);
+                ys = y0 + dv*(a41*k0 + a42*k1 + a43*k2);
+                internal::evaluate(func, v+(c4*dv), ys, k3);
+                ys = y0 + dv*(a51*k0 + a52*k1 + a53*k2 + a54*k3);
+                internal::evaluate(func, v+(c5*dv), ys, k4);
+                ys = y0 + dv*(a61*k0 + a62*k1 + a63*k2 + a64*k3 + a65*k4);
+                internal::evaluate(func, v+dv, ys, k5);
+                y1_ = y0 + dv*(b1*k0 + b3*k2 + b4*k3 + b5*k4 + b6*k5);
+                internal::evaluate(func, v+dv, y1_, k6);
+                evals += 6;
+
+                // The estimate is of the fourth-order solution, so the step is scaled by the power
+                //  1/5 (controller order 6)
+                z1 = y1_ + dv*(e1*k0 + e3*k2 + e4*k3 + e5*k4 + e6*k5 + e7*k6);
+                const auto update = this->controller.template updateError<6>(
+                            dv, limiter.min, this->tolerance.norm(y0, y1_, z1 - y1_), this->tolerance.bound()
+                    );
+                done = update.done;
+                dv_next = update.dv;
+                if(!done) rejected += 1;
+            } while(!done);
+
+            // Stages 5 and 6 are both evaluated at v + dv
+            detector.update(dv, k6 - k5, y1_ - ys);
+
+            v_ = v + dv;
+            v0_ = v;
+            dv_ = dv;
+            y0_ = y0;
+            k0.swap(k6); // By the FSAL (First Same As Last) property, k6 now holds the old k0
+            return return_t{dv, dv_next, y1_, evals, rejected};
+        }
+
+        // Quartic dense output of the last step (the continuous extension of DOPRI5)
+        dense_t dense() const {
+            constexpr auto d1 = value_t(-12715105075) / value_t(11282082432);
+            constexpr auto d3 = value_t(87487479700) / value_t(32700410799);
+            constexpr auto d4 = value_t(-10690763975) / value_t(1880347072);
+            constexpr auto d5 = value_t(701980252875) / value_t(199316789632);
+            constexpr auto d6 = value_t(-1453857185) / value_t(822651844);
+            constexpr auto d7 = value_t(69997945) / value_t(29380423);
+
+            std::array<state_t, 4> F;
+            F[0] = y1_ - y0_;
+            F[1] = dv_*k6 - F[0];
+            F[2] = F[0] - dv_*k0 - F[1];
+            F[3] = dv_*(d1*k6 + d3*k2 + d4*k3 + d5*k4 + d6*k5 + d7*k0);
+            return internal::nestedDense(v0_, dv_, y0_, F);
+        }
+
+        bool stiff() const { return detector.stiff(); }
+
+        value_t stiffness() const { return detector.ratio(); }
+
+    protected:
+        state_t k0;
+        state_t k1;
+        state_t k2;
+        state_t k3;
+        state_t k4;
+        state_t k5;
+        state_t k6;
+        state_t ys; // Stage argument buffer
+        state_t z1;
+        value_t v_; // The integration variable (and y1_ the state) at which k0 was evaluated
+        value_t v0_;
+        value_t dv_;
+        state_t y0_;
+        state_t y1_;
+        internal::StiffnessDetector<value_t> detector;
+};
+
+// TODO: INCLUDE "SOLVING ORDINARY DIFFERENTIAL EQUATIONS I" (HAIRER, NORSETT AND WANNER) IN THE DOCUMENTATION
+//
+// The seventh-order dense output needs three more stages, which are evaluated when the
+//  interpolant is built (Stepper::dense() supplies the system function and adds the evaluations
+//  to the statistics).
+//
+template<typename Value, size_t N>
+class DOP853 : public internal::Adaptive<Value, 8>
+{
+    public:
+        using value_t = Value;
+        using state_t = internal::State<value_t, N>;
+        using return_t = internal::MethodReturnRef<value_t, state_t>;
+        using dense_t = internal::DenseOutput<value_t, state_t, 7>;
+        using coefficients_t = internal::DOP853Coefficients<value_t>;
+
+        static constexpr size_t dense_evals = 3; // System evaluations of each dense(funcs)
+
+        DOP853(const Tolerance<value_t>& _tolerance = internal::defaultTolerance(1e-6, 8),
+               const step::Controller<value_t>& _controller = defaultController())
+            : internal::Adaptive<Value, 8>(_tolerance, _controller), v_(0), v0_(0), dv_(0), detector(value_t(6.1)) {
+            for(auto& stage : k) stage.setZero();
+            for(auto buffer : {&ys, &z1, &err5, &err3, &y0_, &y1_}) buffer->setZero();
+        }
+
+        //
+        // The step size controller of DOP853 with the PI term of DOPRI5, beta = 0.04: (tolerance /
+        //  error)^0.095 * (last tolerance / error)^-0.04, a safety factor of 0.9 and the step
+        //  scaled within [1/6, 3]
+        //
+        static step::Controller<value_t> defaultController() {
+            return step::Controller<value_t>(value_t(0.76), value_t(-0.32), value_t(0), value_t(0.9), value_t(1)/value_t(6), value_t(3));
+        }
+
+        template<typename Func>
+        void init(value_t /*dv*/, value_t v0, const state_t& y0, Func func) {
+            internal::evaluate(func, v0, y0, k[0]);
+            this->controller.reset();
+            v_ = v0;
+            y1_ = y0;
+            v0_ = v0;
+            dv_ = value_t(0);
+        }
+
+        template<typename Func, typename Limiter>
+        return_t operator () (Func func, value_t dv, value_t v, const state_t& y0, Limiter limiter) {
+            using t = coefficients_t;
+            size_t evals = 0;
+            size_t rejected = 0;
+
+            // The first stage is carried over from the last step unless the state was moved
+            if((v != v_) || (y0 != y1_)) {
+                internal::evaluate(func, v, y0, k[0]);
+                evals += 1;
+            }
+
+            auto dv_next = dv;
+            bool done = false;
+
+            do {
+                dv = limiter.constrain(dv_next);
+                for(size_t i = 1; i < 12; ++i) {
+                    ys = y0;
+                    for(size_t j = 0; j < i; ++j) {
+                        const auto a = t::a[t::index(i, j)];
+                        if(a != value_t(0)) ys += (dv*a)*k[j];
+                    }
+                    internal::evaluate(func, v + t::c[i]*dv, ys, k[i]);
+                }
+                evals += 11;
+
+                y1_ = y0;
+                err5.setZero(y0.size());
+                err3.setZero(y0.size());
+                for(size_t j = 0; j < 12; ++j) {
+                    const auto b = t::a[t::index(12, j)];
+                    if(b != value_t(0)) y1_ += (dv*b)*k[j];
+                    if(t::e5[j] != value_t(0)) err5 += t::e5[j]*k[j];
+                    if(t::e3[j] != value_t(0)) err3 += t::e3[j]*k[j];
+                }
+
+                // The fifth-order estimate, corrected by the third-order one as in DOP853
+                const auto n5 = std::abs(dv) * this->tolerance.norm(y0, y1_, err5);
+                const auto n3 = std::abs(dv) * this->tolerance.norm(y0, y1_, err3);
+                const auto den = std::sqrt(n5*n5 + value_t(0.01)*n3*n3);
+                z1 = y1_;
+                if(den > value_t(0)) z1 += ((dv*n5) / den) * err5;
+
+                // The combined estimate is O(dv^8), so the step is scaled by the power 1/8
+                //  (controller order 9)
+                const auto update = this->controller.template updateError<9>(
+                            dv, limiter.min, this->tolerance.norm(y0, y1_, z1 - y1_), this->tolerance.bound()
+                    );
+                done = update.done;
+                dv_next = update.dv;
+                if(!done) rejected += 1;
+            } while(!done);
+
+            internal::evaluate(func, v+dv, y1_, k[12]);
+            evals += 1;
+
+            // Stages 11 and 12 are both evaluated at v + dv
+            detector.update(dv, k[12] - k[11], y1_ - ys);
+
+            v_ = v + dv;
+            v0_ = v;
+            dv_ = dv;
+            y0_ = y0;
+            k[0].swap(k[12]); // By the FSAL (First Same As Last) property, k[12] now holds the old k[0]
+            return return_t{dv, dv_next, y1_, evals, rejected};
+        }
+
+        // Seventh-order dense output of the last step (the continuous extension of DOP853)
+        template<typename Func>
+        dense_t dense(const Func& func) const {
+            using t = coefficients_t;
+
+            std::array<state_t, 3> extra;
+            state_t y;
+            for(size_t i = 13; i < 16; ++i) {
+                y = y0_;
+                for(size_t j = 0; j < i; ++j) {
+                    const auto a = t::a[t::index(i, j)];
+                    if(a != value_t(0)) y += (dv_*a)*stage(extra, j);
+                }
+                internal::evaluate(func, v0_ + t::c[i]*dv_, y, extra[i-13]);
+            }
+
+            std::array<state_t, 7> F;
+            F[0] = y1_ - y0_;
+            F[1] = dv_*stage(extra, 0) - F[0];
+            F[2] = F[0] - dv_*stage(extra, 12) - F[1];
+            for(size_t r = 0; r < 4; ++r) {
+                F[r+3].setZero(y0_.size());
+                for(size_t j = 0; j < 16; ++j) {
+                    if(t::d[r][j] != value_t(0)) F[r+3] += (dv_*t::d[r][j])*stage(extra, j);
+                }
+            }
+            return internal::nestedDense(v0_, dv_, y0_, F);
+        }
+
+        bool stiff() const { return detector.stiff(); }
+
+        value_t stiffness() const { return detector.ratio(); }
+
+    protected:
+        // Stage j of the last step; stages 0 and 12 were exchanged by the FSAL swap
+        const state_t& stage(const std::array<state_t, 3>& extra, size_t j) const {
+            if(j == 0) return k[12];
+            if(j == 12) return k[0];
+            return (j < 12) ? k[j] : extra[j-13];
+        }
+
+        std::array<state_t, 13> k;
+        state_t ys; // Stage argument buffer
+        state_t z1;
+        state_t err5;
+        state_t err3;
+        value_t v_; // The integration variable (and y1_ the state) at which k[0] was evaluated
+        value_t v0_;
+        value_t dv_;
+        state_t y0_;
+        state_t y1_;
+        internal::StiffnessDetector<value_t> detector;
+};
+
+} /*namespace method*/
+} /*namespace epode*/
+
+#endif // EPODE_DORMAND_PRINCE_H
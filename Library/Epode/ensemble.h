@@ -0,0 +1,207 @@
+//
+//
+// File - Epode/ensemble.h:
+//
+//      Implementation of the ensemble() function which runs many independent integrations of a
+//  parameterized system (parameter sweeps, initial state sweeps, Monte-Carlo runs) on a pool of
+//  threads.  Adaptive integrations can have very uneven lengths, so the runs are distributed with
+//  work stealing: every worker starts with a contiguous block of runs and, once it has finished
+//  its own block, it steals half of the remaining block of another worker.  Each run constructs
+//  its own integrator (and so its own copy of the method object) and its results are moved into a
+//  slot of the preallocated output vector, so the workers share no mutable state besides the
+//  run blocks.
+//
+//
+// License:
+//
+//      This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0.
+//  If a copy of the MPL was not distributed with this file, You can obtain one
+//  at http://mozilla.org/MPL/2.0/.
+//
+//
+
+#ifndef EPODE_ENSEMBLE_H
+#define EPODE_ENSEMBLE_H
+
+#include <algorithm>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "core.h"
+#include "output.h"
+#include "solve.h"
+
+namespace epode
+{
+namespace internal
+{
+//
+// A block of run indices owned by one worker.  The owner takes runs from the front and thieves
+//  take the back half.  A mutex is sufficient here as each run is much more expensive than the
+//  (rarely contended) lock.
+//
+class RunBlock
+{
+    public:
+        RunBlock() : begin(0), end(0) {}
+
+        void assign(size_t _begin, size_t _end) {
+            std::lock_guard<std::mutex> lock(mutex);
+            begin = _begin;
+            end = _end;
+        }
+
+        bool pop(size_t& idx) {
+            std::lock_guard<std::mutex> lock(mutex);
+            if(begin == end) return false;
+            idx = begin++;
+            return true;
+        }
+
+        bool steal(size_t& _begin, size_t& _end) {
+            std::lock_guard<std::mutex> lock(mutex);
+            if(begin == end) return false;
+            const auto mid = begin + ((end - begin) / 2);
+            _begin = mid;
+            _end = end;
+            end = mid;
+            return true;
+        }
+
+    protected:
+        std::mutex mutex;
+        size_t begin;
+        size_t end;
+};
+
+//
+// Call task(idx) for every idx in [0, n) on the requested number of threads with work stealing.
+//  The first exception thrown by a task is rethrown on the calling thread.
+//
+template<typename Task>
+void parallelRuns(size_t n, size_t threads, Task task) {
+    threads = std::max<size_t>(1, std::min(threads, n));
+    if(threads == 1) {
+        for(size_t idx = 0; idx < n; ++idx) task(idx);
+        return;
+    }
+
+    auto blocks = std::unique_ptr<RunBlock[]>(new RunBlock[threads]);
+    for(size_t w = 0; w < threads; ++w) {
+        blocks[w].assign((w * n) / threads, ((w + 1) * n) / threads);
+    }
+
+    std::mutex error_mutex;
+    std::exception_ptr error;
+
+    auto worker = [&](size_t w) {
+        try {
+            size_t idx = 0;
+            while(true) {
+                while(blocks[w].pop(idx)) task(idx);
+
+                // Out of work, steal half of the remaining runs of another worker
+                bool stolen = false;
+                for(size_t offset = 1; (offset < threads) && !stolen; ++offset) {
+                    size_t begin = 0, end = 0;
+                    if(blocks[(w + offset) % threads].steal(begin, end)) {
+                        blocks[w].assign(begin, end);
+                        stolen = true;
+                    }
+                }
+                if(!stolen) return;
+            }
+        } catch(...) {
+            std::lock_guard<std::mutex> lock(error_mutex);
+            if(!error) error = std::current_exception();
+        }
+    };
+
+    std::vector<std::thread> pool;
+    pool.reserve(threads - 1);
+    for(size_t w = 1; w < threads; ++w) {
+        pool.emplace_back(worker, w);
+    }
+    worker(0);
+
+    for(auto& thread : pool) thread.join();
+    if(error) std::rethrow_exception(error);
+}
+
+//
+// The initial state of a run may either be a fixed state or a function of the run parameters.
+//  Eigen objects are callable (for indexing), so they are always treated as a fixed state.
+//
+template<typename Initial>
+using isFixedState = std::is_base_of<Eigen::EigenBase<Initial>, Initial>;
+
+template<typename Initial, typename Param,
+         typename = std::enable_if_t<!isFixedState<Initial>::value> >
+auto initialState(const Initial& y0, const Param& param) -> decltype(y0(param)) {
+    return y0(param);
+}
+
+template<typename Initial, typename Param,
+         typename = std::enable_if_t<isFixedState<Initial>::value> >
+const Initial& initialState(const Initial& y0, const Param&) {
+    return y0;
+}
+
+inline size_t defaultThreads() {
+    const auto threads = std::thread::hardware_concurrency();
+    return (threads == 0) ? 1 : threads;
+}
+} /*namespace internal*/
+
+//
+// Run one integration per element of params.  The system for each run is systemFactory(param)
+//  and the initial state is either y0 or, if y0 is callable, y0(param).  The results of run idx
+//  are returned in element idx of the returned vector.
+//
+template<
+	template<typename V, size_t N> class Method,
+	typename SystemFactory, typename Params, typename DValue, typename Value,
+	typename Ender, typename Initial,
+	typename Tolerance = double,
+	typename Output = output::Every>
+auto ensemble(SystemFactory systemFactory, const Params& params,
+              DValue dv, Value v0, Ender end, Initial y0,
+              const Tolerance& tol = Tolerance{1e-6},
+              const Output& output = Output{},
+              size_t threads = internal::defaultThreads())
+{
+    auto run = [&](size_t idx) {
+        const auto& param = params[idx];
+        return solve<Method>(systemFactory(param), dv, v0, end, internal::initialState(y0, param), tol, output);
+    };
+
+    const size_t n = params.size();
+    auto results = std::vector<decltype(run(0))>(n);
+    internal::parallelRuns(n, threads, [&](size_t idx) {
+        results[idx] = run(idx);
+    });
+
+    return results;
+}
+
+template<typename SystemFactory, typename Params, typename DValue, typename Value,
+	typename Ender, typename Initial,
+	typename Tolerance = double,
+	typename Output = output::Every>
+auto ensemble(SystemFactory systemFactory, const Params& params,
+              DValue dv, Value v0, Ender end, Initial y0,
+              const Tolerance& tol = Tolerance{1e-6},
+              const Output& output = Output{},
+              size_t threads = internal::defaultThreads())
+{
+    return ensemble<internal::SolveDefaultMethod>(systemFactory, params, dv, v0, end, y0, tol, output, threads);
+}
+
+} /*namespace epode*/
+
+#endif // EPODE_ENSEMBLE_H
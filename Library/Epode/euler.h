@@ -15,63 +15,47 @@
 
 #ifndef EPODE_EULER_H
 #define EPODE_EULER_H
+
+#include "explicit_rk.h"
+
 namespace epode
 {
-namespace method
+namespace internal
 {
 
-template<typename Value, size_t N>
-class Euler : public internal::Fixed<Value, 1>
+struct EulerTableau
 {
-    public:
-        using value_t = Value;
-        using state_t = internal::State<value_t, N>;
-        using return_t = internal::MethodReturn<value_t, state_t>;
-
-		template<typename Func, typename Limiter>
-        return_t operator () (Func func, value_t dv, value_t v, state_t y, Limiter) {
-            return return_t{dv, dv, y + dv * func(v, y), 1};
-        }
+    static constexpr size_t stages = 1;
+    static constexpr size_t order = 1;
+    static constexpr Rational c[stages] = {0};
+    static constexpr Rational a[stages][stages] = {{}};
+    static constexpr Rational b[stages] = {1};
 };
 
-template<typename Value, size_t N>
-class HeunEuler : public internal::Adaptive<Value, 1>
+// Heun's method with the error estimated by the difference from the Euler step
+struct HeunEulerTableau
 {
-    public:
-        using value_t = Value;
-        using state_t = internal::State<value_t, N>;
-        using return_t = internal::MethodReturn<value_t, state_t>;
-
-        using internal::Adaptive<Value, 1>::Adaptive; // Inherit Construtors
-
-		template<typename Func, typename Limiter>
-        return_t operator () (Func func, value_t dv, value_t v, state_t y0, Limiter limiter) {
-            constexpr auto c0 = value_t(1) / value_t(2);
-
-            const auto k0 = func(v, y0);
-            size_t evals = 1;
+    static constexpr size_t stages = 2;
+    static constexpr size_t order = 1;
+    static constexpr Rational c[stages] = {0, 1};
+    static constexpr Rational a[stages][stages] = {
+        {},
+        {1}
+    };
+    static constexpr Rational b[stages] = {{1, 2}, {1, 2}};
+    static constexpr Rational e[stages] = {{1, 2}, {-1, 2}};
+};
 
-            auto y1 = y0;
-            auto dv_next = dv;
-            bool done = false;
+} /*namespace internal*/
 
-            do {
-                dv = limiter.constrain(dv_next);
-                const auto k1 = func(v+dv, y0+ dv*k0);
+namespace method
+{
 
-                evals += 1;
-                y1 = y0 + c0*dv*(k0 + k1);
-                const auto z1 = y0 + dv*k0;
-                const auto update = step::internal::updateStepSize<1>(
-                            dv, limiter.min, y1, z1, this->tolerance
-                    );
-                done = update.done;
-                dv_next = update.dv;
-            } while(!done);
+template<typename Value, size_t N>
+using Euler = ExplicitRK<Value, N, internal::EulerTableau>;
 
-            return return_t{dv, dv_next, y1, evals};
-        }
-};
+template<typename Value, size_t N>
+using HeunEuler = ExplicitRK<Value, N, internal::HeunEulerTableau>;
 
 } /*namespace method*/
 } /*namespace epode*/
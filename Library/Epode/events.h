@@ -0,0 +1,365 @@
+//
+//
+// File - Epode/events.h:
+//
+//      Zero-crossing events of the integration.  An event is a function of the integration
+//  variable and state, g(v, y), whose sign changes (optionally in one direction only) are located
+//  within the step which contains them rather than at the end of that step.  The crossing is
+//  found by the Illinois method on the dense output of the step, which is built once per step
+//  with a crossing.  For most methods this does not evaluate the system function; DOP853 evaluates
+//  three further stages, which are counted in the statistics.  Methods without dense output are
+//  interpolated linearly between the ends of the step.
+//
+//      When an event occurs the integration may be terminated at the crossing, the crossing may be
+//  recorded in the results or a callback may be called with the state at the crossing.
+//
+//          auto empty = events::terminate([](auto, const auto& y) { return y[0] - 0.05; },
+//                                         events::Direction::Falling);
+//          auto results = solve(system, dv, v0, empty, y0);
+//          auto results = solve(system, dv, v0, events::until(v1, empty, ...), y0);
+//
+//  An event given alone has no end value, so the integration is bounded only by a budget of
+//  default_event_evals system evaluations, after which it ends with Status::EvalLimit.  Where the
+//  event may never fire, give the end with until() -- a value, or a trigger such as
+//  (_v > v1) || triggers::maxEvals(limit).
+//
+//
+// License:
+//
+//      This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0.
+//  If a copy of the MPL was not distributed with this file, You can obtain one
+//  at http://mozilla.org/MPL/2.0/.
+//
+//
+
+#ifndef EPODE_EVENTS_H
+#define EPODE_EVENTS_H
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "dense.h"
+#include "triggers.h"
+
+namespace epode
+{
+namespace events
+{
+
+// The sign changes of the event function which trigger the event
+enum class Direction { Rising, Falling, Either };
+
+// What happens when the event triggers
+enum class Action { Terminate, Record, Callback };
+
+struct NoCallback
+{
+        template<typename Value, typename State>
+        void operator() (const Value&, const State&) const {}
+};
+
+template<typename Condition, typename Callback = NoCallback>
+class Event
+{
+    public:
+        Event(Condition _condition, Direction _direction, Action _action, Callback _callback = Callback{})
+            : condition(_condition), direction(_direction), action(_action), callback(_callback) {}
+
+        // Does the sign change from g0 to g1 trigger the event?
+        template<typename Value>
+        bool triggered(const Value& g0, const Value& g1) const {
+            const auto rising = (g0 < Value(0)) && (g1 >= Value(0));
+            const auto falling = (g0 > Value(0)) && (g1 <= Value(0));
+            switch(direction) {
+                case Direction::Rising: return rising;
+                case Direction::Falling: return falling;
+                default: return rising || falling;
+            }
+        }
+
+        Condition condition;
+        Direction direction;
+        Action action;
+        Callback callback;
+};
+
+//
+// A set of events together with an ordinary end specification (an end value or trigger)
+//
+template<typename Ender, typename... Events>
+class EventSet
+{
+    public:
+        EventSet(Ender _end, Events... _events) : end(_end), events(_events...) {}
+
+        Ender end;
+        std::tuple<Events...> events;
+};
+
+//
+// Event construction functions
+//
+template<typename Condition>
+Event<Condition> terminate(Condition condition, Direction direction = Direction::Either) {
+    return Event<Condition>(condition, direction, Action::Terminate);
+}
+
+template<typename Condition>
+Event<Condition> record(Condition condition, Direction direction = Direction::Either) {
+    return Event<Condition>(condition, direction, Action::Record);
+}
+
+template<typename Condition, typename Callback>
+Event<Condition, Callback> callback(Condition condition, Callback callback, Direction direction = Direction::Either) {
+    return Event<Condition, Callback>(condition, direction, Action::Callback, callback);
+}
+
+template<typename Ender, typename... Events>
+EventSet<Ender, Events...> until(Ender end, Events... events) {
+    return EventSet<Ender, Events...>(end, events...);
+}
+
+namespace internal
+{
+
+//
+// Locate the sign change of g between a and b with the Illinois variant of the regula falsi.
+//  The point returned is within the tolerance of the crossing and on the same side of it as b,
+//  so the event has already occurred there.
+//
+// TODO: INCLUDE "A MODIFIED REGULA FALSI METHOD FOR COMPUTING THE ROOT OF AN EQUATION" (DOWELL, JARRATT) IN THE DOCUMENTATION
+template<typename Value, typename G>
+Value illinois(G& g, Value a, Value ga, Value b, Value gb, const Value& tolerance) {
+    using std::abs;
+    constexpr size_t max_iterations = 64;
+
+    int side = 0;
+    for(size_t iteration = 0; (iteration < max_iterations) && (abs(b - a) > tolerance); ++iteration) {
+        const auto c = b - gb * (b - a) / (gb - ga);
+        const auto gc = g(c);
+        if(gc == Value(0)) return c;
+        if((gc > Value(0)) == (gb > Value(0))) {
+            b = c;
+            gb = gc;
+            if(side == -1) ga /= Value(2);
+            side = -1;
+        } else {
+            a = c;
+            ga = gc;
+            if(side == +1) gb /= Value(2);
+            side = +1;
+        }
+    }
+    return b;
+}
+
+template<typename Tuple, typename F, size_t... Is>
+void forEachImpl(Tuple& t, F& f, std::index_sequence<Is...>) {
+    using expand = int[];
+    (void)expand{0, (f(std::get<Is>(t), Is), 0)...};
+}
+
+// Call f(event, index) for each event of a tuple
+template<typename... Events, typename F>
+void forEach(std::tuple<Events...>& t, F f) {
+    forEachImpl(t, f, std::index_sequence_for<Events...>{});
+}
+
+//
+// The event detector of an integration.  After every step, the crossings within the step are
+//  located and handled in order of the integration variable.  A terminating event moves the end
+//  of the step back to the crossing.  Recorded crossings are stored in the results after the
+//  output of the step, in order of the integration variable.
+//
+template<typename Value, typename State, bool Dense, typename... Events>
+class Detector
+{
+    public:
+        using value_t = Value;
+        using state_t = State;
+        static constexpr size_t count = sizeof...(Events);
+
+        explicit Detector(const std::tuple<Events...>& _events) : events(_events), terminated_(false) {}
+
+        template<typename Stepper>
+        void start(const Stepper& s) {
+            v0 = s.v();
+            if(!Dense) y0 = s.y();
+            forEach(events, [&](auto& event, size_t idx) { g0[idx] = event.condition(v0, s.y()); });
+            terminated_ = false;
+        }
+
+        //
+        // Handle the events in the last step, which was dv long, and return the length of the
+        //  step after any termination
+        //
+        template<typename Stepper>
+        value_t locate(Stepper& s, value_t dv) {
+            const auto v1 = s.v();
+            std::array<value_t, count> g1;
+            std::array<bool, count> triggered;
+            bool any = false;
+            forEach(events, [&](auto& event, size_t idx) {
+                g1[idx] = event.condition(v1, s.y());
+                triggered[idx] = event.triggered(g0[idx], g1[idx]);
+                any = any || triggered[idx];
+            });
+
+            if(any) {
+                dv = handle(s, dv, v1, g1, triggered, interpolant(s, std::integral_constant<bool, Dense>{}));
+            }
+
+            v0 = s.v();
+            if(!Dense) y0 = s.y();
+            g0 = g1;
+            return dv;
+        }
+
+        // Store the recorded crossings of the last step in the results
+        template<typename Stepper, typename Results, typename Transformer>
+        void record(const Stepper& s, Results& results, const Transformer& transformer, value_t dv) {
+            for(const auto& crossing : recorded) {
+                auto pos = std::upper_bound(
+                    results.begin(), results.end(), crossing.first,
+                    [](const value_t& v, const auto& point) { return v < point.v; }
+                );
+                results.emplace(pos, dv, crossing.first, transformer(dv, crossing.first, crossing.second, s.stats()), s.stats());
+            }
+            recorded.clear();
+        }
+
+        bool terminated() const { return terminated_; }
+
+    protected:
+        template<typename Stepper>
+        auto interpolant(Stepper& s, std::true_type) const { return s.dense(); }
+
+        // Linear interpolation for methods without dense output
+        template<typename Stepper>
+        auto interpolant(const Stepper& s, std::false_type) const {
+            const auto va = v0;
+            const auto v1 = s.v();
+            const state_t ya = y0;
+            const state_t dy = s.y() - y0;
+            return [=](value_t v) -> state_t { return ya + ((v - va) / (v1 - va)) * dy; };
+        }
+
+        template<typename Stepper, typename Interpolant>
+        value_t handle(Stepper& s, value_t dv, value_t v1, const std::array<value_t, count>& g1,
+                       const std::array<bool, count>& triggered, const Interpolant& y) {
+            using std::abs;
+            const auto tolerance = value_t(4) * std::numeric_limits<value_t>::epsilon() *
+                    std::max(abs(v0), abs(v1));
+
+            // Locate the crossings
+            std::array<value_t, count> vs;
+            std::array<size_t, count> order;
+            size_t n = 0;
+            forEach(events, [&](auto& event, size_t idx) {
+                if(!triggered[idx]) return;
+                auto g = [&](value_t v) { return event.condition(v, y(v)); };
+                vs[idx] = illinois(g, v0, g0[idx], v1, g1[idx], tolerance);
+                order[n++] = idx;
+            });
+            std::sort(order.begin(), order.begin() + n, [&](size_t a, size_t b) { return vs[a] < vs[b]; });
+
+            // Handle them in order up to the first terminating event
+            for(size_t k = 0; k < n; ++k) {
+                const auto idx = order[k];
+                const auto v = vs[idx];
+                const state_t yv = y(v);
+                forEach(events, [&](auto& event, size_t i) {
+                    if(i != idx) return;
+                    switch(event.action) {
+                        case Action::Terminate:
+                            terminated_ = true;
+                            break;
+                        case Action::Record:
+                            recorded.emplace_back(v, yv);
+                            break;
+                        case Action::Callback:
+                            event.callback(v, yv);
+                            break;
+                    }
+                });
+
+                if(terminated_) {
+                    // The later crossings of the step never happen
+                    s.truncate(v, yv);
+                    return dv - (v1 - v);
+                }
+            }
+            return dv;
+        }
+
+        std::tuple<Events...> events;
+        std::array<value_t, count> g0; // Event functions at the start of the step
+        value_t v0;
+        state_t y0; // The state at the start of the step, for linear interpolation
+        bool terminated_;
+        std::vector<std::pair<value_t, state_t>> recorded;
+};
+
+//
+// The detector of an integration without events
+//
+struct NullDetector
+{
+        template<typename Stepper>
+        void start(const Stepper&) {}
+
+        template<typename Stepper, typename Value>
+        Value locate(Stepper&, Value dv) { return dv; }
+
+        template<typename Stepper, typename Results, typename Transformer, typename Value>
+        void record(const Stepper&, Results&, const Transformer&, Value) {}
+
+        constexpr bool terminated() const { return false; }
+};
+
+//
+// The budget of an integration which is given only an event.  If the event never fires the
+//  integration ends with Status::EvalLimit after this many system evaluations; give an end value
+//  or budget with until() to change it.
+//
+constexpr size_t default_event_evals = 10000000;
+
+//
+// Split an end specification into the end value or trigger and the events
+//
+template<typename Ender>
+const Ender& endOf(const Ender& end) { return end; }
+
+template<typename Ender, typename... Events>
+const Ender& endOf(const EventSet<Ender, Events...>& set) { return set.end; }
+
+template<typename Condition, typename Callback>
+triggers::internal::MaxEvals endOf(const Event<Condition, Callback>&) {
+    return triggers::maxEvals(default_event_evals);
+}
+
+template<typename Value, typename State, bool Dense, typename Ender>
+NullDetector makeDetector(const Ender&) { return NullDetector{}; }
+
+template<typename Value, typename State, bool Dense, typename Ender, typename... Events>
+Detector<Value, State, Dense, Events...> makeDetector(const EventSet<Ender, Events...>& set) {
+    return Detector<Value, State, Dense, Events...>(set.events);
+}
+
+template<typename Value, typename State, bool Dense, typename Condition, typename Callback>
+Detector<Value, State, Dense, Event<Condition, Callback>> makeDetector(const Event<Condition, Callback>& event) {
+    return Detector<Value, State, Dense, Event<Condition, Callback>>(std::make_tuple(event));
+}
+
+} /*namespace internal*/
+} /*namespace events*/
+} /*namespace epode*/
+
+#endif // EPODE_EVENTS_H
@@ -0,0 +1,359 @@
+//
+//
+// File - Epode/explicit_rk.h:
+//
+//      A generic explicit Runge-Kutta method generated at compile time from a Butcher tableau.
+//  The tableau is a type with static constexpr rational coefficients; from it the stages are
+//  unrolled into one fused expression each, with the zero coefficients removed, and the
+//  remaining structure of the method is inferred:
+//
+//      - An embedded error estimate, e, makes the method adaptive; without it, it is fixed-step.
+//          The estimate is of the order of the tableau, unless an error_order is given, and the
+//          step size controller scales the step by the power 1/(error_order + 1).
+//      - If the last stage is evaluated at the solution (c = 1 and its row of a equal to b) the
+//          method is FSAL (First Same As Last) and the last stage is the first of the next step.
+//          Otherwise the derivative at the end of the step is evaluated once a step is accepted.
+//      - Either way, the first stage of a step is carried over from the last step, so the cost of
+//          a step is always one evaluation per stage after the first.
+//      - A dense_degree of 3 gives cubic Hermite dense output; 4 gives a quartic interpolant
+//          using a midpoint value formed with the weights, mid, over the stages and the end
+//          point derivative (index stages).
+//
+//  A tableau may also give a second error estimate, e_early, which is checked before the last
+//  stage of an FSAL method is evaluated so that rejected steps do not pay for it.
+//
+//
+// License:
+//
+//      This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0.
+//  If a copy of the MPL was not distributed with this file, You can obtain one
+//  at http://mozilla.org/MPL/2.0/.
+//
+//
+
+#ifndef EPODE_EXPLICIT_RK_H
+#define EPODE_EXPLICIT_RK_H
+
+#include <array>
+#include <limits>
+#include <type_traits>
+#include <utility>
+
+#include "core.h"
+#include "dense.h"
+#include "step.h"
+
+namespace epode
+{
+namespace internal
+{
+
+//
+// An exact tableau coefficient, converted to the value type at compile time
+//
+struct Rational
+{
+    constexpr Rational(long long _num = 0, long long _den = 1) : num(_num), den(_den) {}
+
+    template<typename Value>
+    constexpr Value value() const { return Value(num) / Value(den); }
+
+    constexpr bool zero() const { return num == 0; }
+
+    long long num;
+    long long den;
+};
+
+constexpr bool operator == (const Rational& a, const Rational& b) {
+    return (a.num * b.den) == (b.num * a.den);
+}
+
+//
+// Detection of the optional parts of a tableau
+//
+template<typename Tableau, typename = void>
+struct hasErrorWeights : std::false_type {};
+
+template<typename Tableau>
+struct hasErrorWeights<Tableau, decltype(void(Tableau::e[0]))> : std::true_type {};
+
+template<typename Tableau, typename = void>
+struct hasEarlyErrorWeights : std::false_type {};
+
+template<typename Tableau>
+struct hasEarlyErrorWeights<Tableau, decltype(void(Tableau::e_early[0]))> : std::true_type {};
+
+template<typename Tableau, typename = void>
+struct tableauErrorOrder : std::integral_constant<size_t, Tableau::order> {};
+
+template<typename Tableau>
+struct tableauErrorOrder<Tableau, decltype(void(Tableau::error_order))>
+    : std::integral_constant<size_t, Tableau::error_order> {};
+
+template<typename Tableau, typename = void>
+struct tableauDenseDegree : std::integral_constant<size_t, 0> {};
+
+template<typename Tableau>
+struct tableauDenseDegree<Tableau, decltype(void(Tableau::dense_degree))>
+    : std::integral_constant<size_t, Tableau::dense_degree> {};
+
+// The last stage is the solution of the step, so it is also the first stage of the next
+template<typename Tableau>
+constexpr bool firstSameAsLast() {
+    constexpr size_t s = Tableau::stages;
+    if((s < 2) || !(Tableau::c[s-1] == Rational(1)) || !Tableau::b[s-1].zero()) return false;
+    for(size_t j = 0; j < s-1; ++j) {
+        if(!(Tableau::a[s-1][j] == Tableau::b[j])) return false;
+    }
+    return true;
+}
+
+//
+// Rows of coefficients over the stages
+//
+template<typename Tableau, size_t I>
+struct StageRow { static constexpr Rational get(size_t j) { return Tableau::a[I][j]; } };
+
+template<typename Tableau>
+struct SolutionRow { static constexpr Rational get(size_t j) { return Tableau::b[j]; } };
+
+template<typename Tableau>
+struct ErrorRow { static constexpr Rational get(size_t j) { return Tableau::e[j]; } };
+
+template<typename Tableau>
+struct EarlyErrorRow { static constexpr Rational get(size_t j) { return Tableau::e_early[j]; } };
+
+template<typename Tableau>
+struct MidpointRow { static constexpr Rational get(size_t j) { return Tableau::mid[j]; } };
+
+// The indices, j < Count, of the nonzero coefficients of a row
+template<typename Row, size_t J, size_t Count, size_t... Js>
+struct NonZeroImpl
+{
+    using type = typename std::conditional_t<
+            Row::get(J).zero(),
+            NonZeroImpl<Row, J+1, Count, Js...>,
+            NonZeroImpl<Row, J+1, Count, Js..., J>
+        >::type;
+};
+
+template<typename Row, size_t Count, size_t... Js>
+struct NonZeroImpl<Row, Count, Count, Js...>
+{
+    using type = std::index_sequence<Js...>;
+};
+
+template<typename Row, size_t Count>
+using NonZero = typename NonZeroImpl<Row, 0, Count>::type;
+
+template<typename Value, typename State, size_t Degree>
+struct ExplicitRKDense { using dense_t = DenseOutput<Value, State, Degree>; };
+
+template<typename Value, typename State>
+struct ExplicitRKDense<Value, State, 0> {};
+
+template<typename Value, typename Tableau>
+using ExplicitRKBase = std::conditional_t<
+        hasErrorWeights<Tableau>::value,
+        Adaptive<Value, Tableau::order>,
+        Fixed<Value, Tableau::order>
+    >;
+
+} /*namespace internal*/
+
+namespace method
+{
+
+template<typename Value, size_t N, typename Tableau>
+class ExplicitRK
+    : public internal::ExplicitRKBase<Value, Tableau>,
+      public internal::ExplicitRKDense<Value, internal::State<Value, N>, internal::tableauDenseDegree<Tableau>::value>
+{
+    public:
+        using value_t = Value;
+        using state_t = internal::State<value_t, N>;
+        using return_t = internal::MethodReturnRef<value_t, state_t>;
+        using tableau_t = Tableau;
+
+        static constexpr size_t stages = Tableau::stages;
+        static constexpr bool fsal = internal::firstSameAsLast<Tableau>();
+        static constexpr size_t dense_degree = internal::tableauDenseDegree<Tableau>::value;
+
+        using internal::ExplicitRKBase<Value, Tableau>::ExplicitRKBase; // Inherit Constructors
+
+        template<typename Func>
+        void init(value_t /*dv*/, value_t v0, const state_t& y0, Func func) {
+            internal::evaluate(func, v0, y0, k[0]);
+            v_ = v0;
+            y1_ = y0;
+            resetController(internal::hasErrorWeights<Tableau>{});
+        }
+
+        template<typename Func, typename Limiter>
+        return_t operator () (Func func, value_t dv, value_t v, const state_t& y0, Limiter limiter) {
+            using adaptive_t = internal::hasErrorWeights<Tableau>;
+            using early_t = internal::hasEarlyErrorWeights<Tableau>;
+
+            size_t evals = 0;
+            size_t rejected = 0;
+
+            // The first stage is carried over from the last step unless the state was moved
+            if((v != v_) || (y0 != y1_)) {
+                internal::evaluate(func, v, y0, k[0]);
+                evals += 1;
+            }
+
+            auto dv_next = dv;
+            bool done = false;
+
+            do {
+                if(adaptive_t::value) dv = limiter.constrain(dv_next);
+                evaluateStages(func, dv, v, y0, std::make_index_sequence<inner_stages>{});
+                evals += inner_stages;
+                combine<internal::SolutionRow<Tableau>, false>(
+                        y1_, y0, dv, internal::NonZero<internal::SolutionRow<Tableau>, stages>{}
+                    );
+
+                auto update = checkError<internal::EarlyErrorRow<Tableau>, false>(dv, limiter, y0, y1_, early_t{});
+                if(update.done && fsal) {
+                    internal::evaluate(func, v+dv, y1_, k[last]);
+                    evals += 1;
+                }
+                if(update.done) {
+                    update = checkError<internal::ErrorRow<Tableau>, true>(dv, limiter, y0, y1_, adaptive_t{});
+                }
+                done = update.done;
+                dv_next = update.dv;
+                if(!done) rejected += 1;
+            } while(!done);
+
+            // The derivative at the end of the step is the first stage of the next step and it
+            //  is also the end point derivative of the dense output
+            if(!fsal) {
+                internal::evaluate(func, v+dv, y1_, k[last]);
+                evals += 1;
+            }
+
+            if(dense_degree > 0) {
+                v0_ = v;
+                dv_ = dv;
+                y0_ = y0;
+            }
+            v_ = v + dv;
+            k[0].swap(k[last]); // k[last] now holds the old k[0]
+            return return_t{dv, dv_next, y1_, evals, rejected};
+        }
+
+        // Cubic Hermite dense output of the last step from the end point derivatives
+        template<size_t Degree = dense_degree, std::enable_if_t<Degree == 3, int> = 0>
+        internal::DenseOutput<value_t, state_t, 3> dense() const {
+            return internal::hermiteCubic(v0_, dv_, y0_, k[last], y1_, k[0]);
+        }
+
+        // Quartic dense output of the last step.  The midpoint value is a fourth-order
+        //  combination of the existing stages, so no additional function evaluations are needed.
+        template<size_t Degree = dense_degree, std::enable_if_t<Degree == 4, int> = 0>
+        internal::DenseOutput<value_t, state_t, 4> dense() const {
+            using row_t = internal::MidpointRow<Tableau>;
+            state_t y_half;
+            combine<row_t, true>(y_half, y0_, dv_, internal::NonZero<row_t, stages + 1>{});
+            return internal::hermiteQuartic(v0_, dv_, y0_, k[last], y1_, k[0], y_half);
+        }
+
+    protected:
+        // Stages evaluated in the loop, after the first and before the FSAL stage
+        static constexpr size_t inner_stages = fsal ? (stages - 2) : (stages - 1);
+
+        // The buffer of the end point derivative (the FSAL stage or an additional evaluation)
+        static constexpr size_t last = fsal ? (stages - 1) : stages;
+
+        // The buffer of stage j, which is exchanged with the end point derivative after a step
+        static constexpr size_t slot(size_t j, bool swapped) {
+            return !swapped ? j : ((j == 0) ? last : ((j == last) ? 0 : j));
+        }
+
+        template<typename Row, bool Swapped, size_t J>
+        auto weighted(std::index_sequence<J>) const {
+            constexpr auto w = Row::get(J).template value<value_t>();
+            return w*k[slot(J, Swapped)];
+        }
+
+        template<typename Row, bool Swapped, size_t J0, size_t J1, size_t... Js>
+        auto weighted(std::index_sequence<J0, J1, Js...>) const {
+            constexpr auto w = Row::get(J0).template value<value_t>();
+            return w*k[slot(J0, Swapped)] + weighted<Row, Swapped>(std::index_sequence<J1, Js...>{});
+        }
+
+        // result = base + dv * sum_j w_j*k_j over the nonzero weights of a row
+        template<typename Row, bool Swapped, size_t... Js>
+        void combine(state_t& result, const state_t& base, value_t dv, std::index_sequence<Js...> js) const {
+            result = base + dv*weighted<Row, Swapped>(js);
+        }
+
+        template<typename Row, bool Swapped>
+        void combine(state_t& result, const state_t& base, value_t, std::index_sequence<>) const {
+            result = base;
+        }
+
+        template<size_t I, typename Func>
+        void evaluateStage(Func& func, value_t dv, value_t v, const state_t& y0) {
+            using row_t = internal::StageRow<Tableau, I>;
+            constexpr auto c = Tableau::c[I].template value<value_t>();
+            combine<row_t, false>(ys, y0, dv, internal::NonZero<row_t, I>{});
+            internal::evaluate(func, v+(c*dv), ys, k[I]);
+        }
+
+        template<typename Func, size_t... Is>
+        void evaluateStages(Func& func, value_t dv, value_t v, const state_t& y0, std::index_sequence<Is...>) {
+            using expand = int[];
+            (void)expand{0, (evaluateStage<Is+1>(func, dv, v, y0), 0)...};
+        }
+
+        // Single stage tableaus have no inner stages
+        template<typename Func>
+        void evaluateStages(Func&, value_t, value_t, const state_t&, std::index_sequence<>) {}
+
+        //
+        // Check the error estimate y1 - z1 = dv * sum_j e_j*k_j, if the tableau has one.  Only the
+        //  final estimate of a step enters the history of the step size controller.
+        //
+        template<typename Row, bool Final, typename Limiter>
+        step::internal::StepSizeUpdate<value_t> checkError(
+                    value_t dv, const Limiter& limiter, const state_t& y0, const state_t& y1, std::true_type) {
+            combine<Row, false>(z1, y1, dv, internal::NonZero<Row, stages>{});
+            // The local error of an estimate of order p is O(dv^(p+1)), so the scaling exponent is
+            //  1/(p+1), which is that of the controller order p + 2
+            constexpr size_t controller_order = internal::tableauErrorOrder<Tableau>::value + 2;
+            const auto error = this->tolerance.norm(y0, y1, z1 - y1);
+            if(Final) {
+                return this->controller.template updateError<controller_order>(dv, limiter.min, error, this->tolerance.bound());
+            }
+            return this->controller.template checkError<controller_order>(dv, limiter.min, error, this->tolerance.bound());
+        }
+
+        template<typename Row, bool Final, typename Limiter>
+        step::internal::StepSizeUpdate<value_t> checkError(
+                    value_t dv, const Limiter&, const state_t&, const state_t&, std::false_type) {
+            return {true, dv};
+        }
+
+        void resetController(std::true_type) { this->controller.reset(); }
+        void resetController(std::false_type) {}
+
+        std::array<state_t, last + 1> k;
+
+        // Stage buffers, reused for every step
+        state_t ys;
+        state_t z1;
+        state_t y1_;
+
+        value_t v_ = std::numeric_limits<value_t>::quiet_NaN(); // The integration variable (and y1_ the state) of k[0]
+        value_t v0_;
+        value_t dv_;
+        state_t y0_;
+};
+
+} /*namespace method*/
+} /*namespace epode*/
+
+#endif // EPODE_EXPLICIT_RK_H
@@ -0,0 +1,353 @@
+//
+//
+// File - Epode/implicit.h:
+//
+//      Support for the implicit (and linearly implicit) integration methods.  Implicit methods
+//  receive the whole tuple of application functions rather than only the system function.  The
+//  second function of the tuple, when present, is the Jacobian of the system:
+//
+//          epode::fns(f, jac)
+//
+//  where jac(v, y) returns the N x N matrix J(i, j) = df_i/dy_j (or jac(v, y, J) writes it into
+//  J).  Without a Jacobian function, the Jacobian is approximated by forward differences, which
+//  costs N system evaluations.  When a sparsity pattern (an Eigen sparse matrix with the structure
+//  of the Jacobian) is passed instead, epode::fns(f, pattern), columns which do not share a row
+//  are perturbed together.  Large systems can also use sparse Jacobian storage, see sparse.h.
+//
+//      The linear algebra used by the methods is provided by a linearization class which owns
+//  the Jacobian, the iteration matrix (scale*I - J) and its factorization.  The methods only
+//  call jacobian(), factor() and solve() on it, so the storage and solver can be changed without
+//  changing the methods.
+//
+//
+// License:
+//
+//      This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0.
+//  If a copy of the MPL was not distributed with this file, You can obtain one
+//  at http://mozilla.org/MPL/2.0/.
+//
+//
+
+#ifndef EPODE_IMPLICIT_H
+#define EPODE_IMPLICIT_H
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <limits>
+#include <numeric>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <Eigen/Dense>
+
+#include "core.h"
+
+namespace epode
+{
+namespace internal
+{
+//
+// Select the functions passed to a method: implicit methods receive the whole tuple, explicit
+//  methods only the system function.
+//
+template<typename Method, typename Funcs,
+         typename = std::enable_if_t<!Method::implicit> >
+auto& methodFunctions(Funcs& funcs) { return std::get<0>(funcs); }
+
+template<typename Method, typename Funcs,
+         typename = std::enable_if_t<Method::implicit>, typename = void>
+Funcs& methodFunctions(Funcs& funcs) { return funcs; }
+
+//
+// A sparsity pattern (an Eigen sparse matrix) passed in place of the Jacobian function
+//
+template<typename T, typename = void>
+struct isPattern : std::false_type {};
+
+template<typename T>
+struct isPattern<T, decltype(std::declval<const T&>().isCompressed(), void())> : std::true_type {};
+
+template<typename Funcs, size_t Size = std::tuple_size<std::decay_t<Funcs>>::value>
+struct hasJacobian : std::integral_constant<bool, !isPattern<std::tuple_element_t<1, std::decay_t<Funcs>>>::value> {};
+
+template<typename Funcs>
+struct hasJacobian<Funcs, 1> : std::false_type {};
+
+//
+// Select the sparsity pattern from the application functions, if one was passed
+//
+template<typename Funcs, size_t Size = std::tuple_size<std::decay_t<Funcs>>::value>
+struct JacobianPattern
+{
+        static constexpr bool available = (Size > 2) ||
+            ((Size == 2) && isPattern<std::tuple_element_t<1, std::decay_t<Funcs>>>::value);
+        static constexpr size_t index = (Size > 2) ? 2 : 1;
+
+        static const auto& get(const Funcs& funcs) { return std::get<index>(funcs); }
+};
+
+template<typename Funcs>
+struct JacobianPattern<Funcs, 1>
+{
+        static constexpr bool available = false;
+};
+
+template<typename Value, size_t N>
+using Jacobian = Eigen::Matrix<Value, stateColumns(N), stateColumns(N)>;
+
+//
+// Curtis-Powell-Reid grouping of the columns of a sparsity pattern.  Columns which have no
+//  non-zero row in common are given the same color and are perturbed together, so a forward
+//  difference Jacobian costs one evaluation per color instead of one per column (about the
+//  bandwidth for a banded system).
+//
+struct ColumnColoring
+{
+        using index_t = Eigen::Index;
+
+        size_t colors() const { return (color_start.empty()) ? 0 : color_start.size() - 1; }
+
+        std::vector<index_t> color_start;   // The columns of color c are columns[color_start[c], color_start[c+1])
+        std::vector<index_t> columns;
+        std::vector<index_t> row_start;     // The rows of column j are rows[row_start[j], row_start[j+1])
+        std::vector<index_t> rows;
+};
+
+// Greedy coloring, taking the columns in order
+template<typename Pattern>
+ColumnColoring colorColumns(const Pattern& pattern) {
+    using index_t = ColumnColoring::index_t;
+    const auto n_rows = static_cast<size_t>(pattern.rows());
+    const auto n_cols = static_cast<size_t>(pattern.cols());
+
+    // Non-zeros by column (rows in ascending order) and by row
+    std::vector<std::pair<index_t, index_t>> entries;
+    for(index_t outer = 0; outer < pattern.outerSize(); ++outer) {
+        for(typename Pattern::InnerIterator it(pattern, outer); it; ++it) {
+            entries.emplace_back(it.col(), it.row());
+        }
+    }
+    std::sort(entries.begin(), entries.end());
+
+    ColumnColoring coloring;
+    coloring.row_start.assign(n_cols + 1, 0);
+    coloring.rows.reserve(entries.size());
+    std::vector<index_t> row_count(n_rows + 1, 0);
+    for(const auto& entry : entries) {
+        coloring.row_start[entry.first + 1] += 1;
+        coloring.rows.push_back(entry.second);
+        row_count[entry.second + 1] += 1;
+    }
+    std::partial_sum(coloring.row_start.begin(), coloring.row_start.end(), coloring.row_start.begin());
+    std::partial_sum(row_count.begin(), row_count.end(), row_count.begin());
+    std::vector<index_t> row_columns(entries.size());
+    std::vector<index_t> row_fill(row_count.begin(), row_count.end() - 1);
+    for(const auto& entry : entries) {
+        row_columns[row_fill[entry.second]++] = entry.first;
+    }
+
+    // Give each column the lowest color not used by a column sharing one of its rows
+    std::vector<index_t> color(n_cols, -1);
+    std::vector<index_t> forbidden;
+    index_t colors = 0;
+    for(index_t col = 0; col < static_cast<index_t>(n_cols); ++col) {
+        for(auto k = coloring.row_start[col]; k < coloring.row_start[col+1]; ++k) {
+            const auto row = coloring.rows[k];
+            for(auto j = row_count[row]; j < row_count[row+1]; ++j) {
+                const auto other = color[row_columns[j]];
+                if(other >= 0) forbidden[other] = col;
+            }
+        }
+        index_t c = 0;
+        while((c < colors) && (forbidden[c] == col)) ++c;
+        if(c == colors) {
+            colors += 1;
+            forbidden.push_back(-1);
+        }
+        color[col] = c;
+    }
+
+    coloring.color_start.assign(colors + 1, 0);
+    for(const auto c : color) coloring.color_start[c + 1] += 1;
+    std::partial_sum(coloring.color_start.begin(), coloring.color_start.end(), coloring.color_start.begin());
+    coloring.columns.resize(n_cols);
+    std::vector<index_t> color_fill(coloring.color_start.begin(), coloring.color_start.end() - 1);
+    for(index_t col = 0; col < static_cast<index_t>(n_cols); ++col) {
+        coloring.columns[color_fill[color[col]]++] = col;
+    }
+    return coloring;
+}
+
+//
+// Evaluate a Jacobian function into J.  A Jacobian function which returns the number of system
+//  evaluations it made (as the automatic Jacobians of autodiff.h do) has them counted with the
+//  Jacobian evaluations; other Jacobian functions count none.
+//
+template<typename Func, typename Value, typename YState, typename Matrix>
+auto evaluateJacobianImpl(Func& jac, const Value& v, const YState& y, Matrix& J, int)
+-> decltype(static_cast<size_t>(jac(v, y, J))) {
+    return static_cast<size_t>(jac(v, y, J));
+}
+
+template<typename Func, typename Value, typename YState, typename Matrix>
+size_t evaluateJacobianImpl(Func& jac, const Value& v, const YState& y, Matrix& J, long) {
+    evaluate(jac, v, y, J);
+    return 0;
+}
+
+template<typename Func, typename Value, typename YState, typename Matrix>
+size_t evaluateJacobian(Func& jac, const Value& v, const YState& y, Matrix& J) {
+    return evaluateJacobianImpl(jac, v, y, J, 0);
+}
+
+//
+// Forward difference Jacobian with grouped columns.  Each non-zero is passed to store as
+//  (column, index within the column, row, value).  The number of evaluations is returned.
+//
+template<typename Func, typename Value, typename State, typename Store>
+size_t coloredDifferences(Func& func, Value v, const State& y, const State& f0,
+                          const ColumnColoring& coloring, State& yp, State& fp, Store store) {
+    const auto eps = std::sqrt(std::numeric_limits<Value>::epsilon());
+
+    yp = y;
+    for(size_t c = 0; c < coloring.colors(); ++c) {
+        const auto first = coloring.color_start[c];
+        const auto last = coloring.color_start[c+1];
+        for(auto k = first; k < last; ++k) {
+            const auto col = coloring.columns[k];
+            yp[col] = y[col] + eps * std::max(std::abs(y[col]), Value(1));
+        }
+        evaluate(func, v, yp, fp);
+        for(auto k = first; k < last; ++k) {
+            const auto col = coloring.columns[k];
+            const auto dy = yp[col] - y[col];
+            for(auto idx = coloring.row_start[col]; idx < coloring.row_start[col+1]; ++idx) {
+                const auto row = coloring.rows[idx];
+                store(col, idx - coloring.row_start[col], row, (fp[row] - f0[row]) / dy);
+            }
+            yp[col] = y[col];
+        }
+    }
+    return coloring.colors();
+}
+
+//
+// Dense Jacobian storage and LU factorization with partial pivoting.  Besides the real iteration
+//  matrix, a complex shifted matrix, (alpha + i*beta)*I - J, may be factored for methods (such as
+//  Radau IIA) whose stage systems decouple into real and complex conjugate parts.
+//
+template<typename Value, size_t N>
+class DenseLinearization
+{
+    public:
+        using value_t = Value;
+        using complex_t = std::complex<value_t>;
+        using state_t = State<value_t, N>;
+        using jacobian_t = Jacobian<value_t, N>;
+        using complex_jacobian_t = Eigen::Matrix<complex_t, stateColumns(N), stateColumns(N)>;
+        using complex_state_t = Eigen::Matrix<complex_t, stateColumns(N), 1>;
+
+        //
+        // Update the Jacobian at (v, y), where f0 = f(v, y).  The number of system function
+        //  evaluations used (zero with a Jacobian function) is returned.
+        //
+        template<typename Funcs>
+        size_t jacobian(Funcs& funcs, value_t v, const state_t& y, const state_t& f0) {
+            return jacobianImpl(funcs, v, y, f0, hasJacobian<Funcs>{},
+                                std::integral_constant<bool, JacobianPattern<Funcs>::available>{});
+        }
+
+        // Factor the iteration matrix, scale*I - J
+        void factor(value_t scale) {
+            m = -J;
+            m.diagonal().array() += scale;
+            lu.compute(m);
+        }
+
+        // Solve (scale*I - J) x = rhs, for row vector states
+        template<typename Rhs, typename X>
+        void solve(const Rhs& rhs, X& x) const {
+            x.transpose() = lu.solve(rhs.transpose());
+        }
+
+        // Factor the complex iteration matrix, (alpha + i*beta)*I - J
+        void factor(value_t alpha, value_t beta) {
+            mc = (-J).template cast<complex_t>();
+            mc.diagonal().array() += complex_t(alpha, beta);
+            luc.compute(mc);
+        }
+
+        //
+        // Solve ((alpha + i*beta)*I - J) (x_re + i*x_im) = rhs_re + i*rhs_im.  The permutation and
+        //  the triangular solves are applied in place, as PartialPivLU::solve() allocates a
+        //  temporary for complex right hand sides.
+        //
+        template<typename Re, typename Im, typename XRe, typename XIm>
+        void solve(const Re& rhs_re, const Im& rhs_im, XRe& x_re, XIm& x_im) {
+            bc.resize(rhs_re.size());
+            bc.real() = rhs_re.transpose();
+            bc.imag() = rhs_im.transpose();
+            xc.noalias() = luc.permutationP() * bc;
+            luc.matrixLU().template triangularView<Eigen::UnitLower>().solveInPlace(xc);
+            luc.matrixLU().template triangularView<Eigen::Upper>().solveInPlace(xc);
+            x_re = xc.real().transpose();
+            x_im = xc.imag().transpose();
+        }
+
+        const jacobian_t& matrix() const { return J; }
+
+    protected:
+        template<typename Funcs, typename Pattern>
+        size_t jacobianImpl(Funcs& funcs, value_t v, const state_t& y, const state_t&, std::true_type, Pattern) {
+            return evaluateJacobian(std::get<1>(funcs), v, y, J);
+        }
+
+        // Forward differences over the non-zeros of a sparsity pattern, with grouped columns
+        template<typename Funcs>
+        size_t jacobianImpl(Funcs& funcs, value_t v, const state_t& y, const state_t& f0, std::false_type, std::true_type) {
+            if(coloring.columns.empty()) coloring = colorColumns(JacobianPattern<Funcs>::get(funcs));
+            J.setZero(y.size(), y.size());
+            return coloredDifferences(std::get<0>(funcs), v, y, f0, coloring, yp, fp,
+                [this](Eigen::Index col, Eigen::Index, Eigen::Index row, value_t dfdy) {
+                    J(row, col) = dfdy;
+                }
+            );
+        }
+
+        // Forward differences, one column per evaluation
+        template<typename Funcs>
+        size_t jacobianImpl(Funcs& funcs, value_t v, const state_t& y, const state_t& f0, std::false_type, std::false_type) {
+            const auto n = y.size();
+            const auto eps = std::sqrt(std::numeric_limits<value_t>::epsilon());
+
+            J.resize(n, n);
+            yp = y;
+            for(Eigen::Index idx = 0; idx < n; ++idx) {
+                const auto delta = eps * std::max(std::abs(y[idx]), value_t(1));
+                yp[idx] = y[idx] + delta;
+                evaluate(std::get<0>(funcs), v, yp, fp);
+                J.col(idx) = ((fp - f0) / (yp[idx] - y[idx])).transpose();
+                yp[idx] = y[idx];
+            }
+            return static_cast<size_t>(n);
+        }
+
+        jacobian_t J;
+        jacobian_t m;
+        Eigen::PartialPivLU<jacobian_t> lu;
+        complex_jacobian_t mc;
+        Eigen::PartialPivLU<complex_jacobian_t> luc;
+        complex_state_t bc;
+        complex_state_t xc;
+        ColumnColoring coloring;
+        state_t yp;
+        state_t fp;
+};
+
+} /*namespace internal*/
+} /*namespace epode*/
+
+#endif // EPODE_IMPLICIT_H
@@ -0,0 +1,215 @@
+//
+//
+// File - Epode/instrument.h:
+//
+//      Integration statistics and the instrumentation policies which select them.  The default
+//  policy, instrument::Counters, counts steps, evaluations, rejections and the linear algebra of
+//  the implicit methods.  The instrument::Detailed policy adds timers of the system function and
+//  of the method overhead, step size statistics, a histogram of the step size changes made by
+//  the controller and the Newton iterations of the implicit methods.  The policy is a template
+//  parameter of the Stepper and Integrator, so the counters-only policy compiles to exactly the
+//  code it replaces.
+//
+//          epode::Integrator<double, 2, epode::method::DP45, epode::instrument::Detailed> integrator(dv, tol);
+//
+//
+// License:
+//
+//      This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0.
+//  If a copy of the MPL was not distributed with this file, You can obtain one
+//  at http://mozilla.org/MPL/2.0/.
+//
+//
+
+#ifndef EPODE_INSTRUMENT_H
+#define EPODE_INSTRUMENT_H
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <tuple>
+#include <utility>
+
+#include "core.h"
+
+namespace epode
+{
+namespace instrument
+{
+// Count steps, evaluations, rejections and linear algebra (the default)
+struct Counters {};
+
+// As Counters, with timers, step size statistics and a histogram of step size changes
+struct Detailed {};
+} /*namespace instrument*/
+
+namespace internal
+{
+struct IntegratorStatistics
+{
+        IntegratorStatistics()
+            : steps(0), evals(0), rejected(0), jacobians(0), decompositions(0), jacobian_evals(0),
+              status(Status::Running) {}
+
+        IntegratorStatistics& update(size_t _steps, size_t _evals, size_t _rejected = 0,
+                                     size_t _jacobians = 0, size_t _decompositions = 0,
+                                     size_t _jacobian_evals = 0) {
+            steps += _steps;
+            evals += _evals;
+            rejected += _rejected;
+            jacobians += _jacobians;
+            decompositions += _decompositions;
+            jacobian_evals += _jacobian_evals;
+            return *this;
+        }
+
+        size_t steps;           // Accepted steps
+        size_t evals;
+        size_t rejected;        // Rejected step attempts, each wasting its evaluations
+        size_t jacobians;       // Jacobian evaluations (implicit methods)
+        size_t decompositions;  // Matrix factorizations (implicit methods)
+        size_t jacobian_evals;  // System evaluations for finite difference and automatic Jacobians (not in evals)
+        Status status;          // Why the integration ended
+};
+
+struct DetailedStatistics : public IntegratorStatistics
+{
+        // Histogram bins of log2(dv_next / dv): below -3, [-3, -2), ..., [2, 3) and from 3
+        static constexpr size_t scale_bins = 8;
+
+        DetailedStatistics()
+            : IntegratorStatistics(), iterations(0), system_time(0), method_time(0),
+              dv_min(std::numeric_limits<double>::infinity()), dv_max(0), dv_sum(0), scales{} {}
+
+        double dvMean() const { return (steps == 0) ? 0.0 : dv_sum / static_cast<double>(steps); }
+
+        // The fraction of the stepping time spent in the system function
+        double systemFraction() const {
+            const auto total = system_time + method_time;
+            return (total == 0.0) ? 0.0 : system_time / total;
+        }
+
+        void stepped(double dv, double dv_next) {
+            dv_min = std::min(dv_min, dv);
+            dv_max = std::max(dv_max, dv);
+            dv_sum += dv;
+
+            const auto ratio = dv_next / dv;
+            auto bin = 0;
+            if(ratio > 0.0) {
+                bin = static_cast<int>(std::floor(std::log2(ratio))) + 4;
+                bin = std::max(0, std::min(static_cast<int>(scale_bins) - 1, bin));
+            }
+            scales[static_cast<size_t>(bin)] += 1;
+        }
+
+        size_t iterations;      // Newton iterations (implicit methods)
+        double system_time;     // Seconds in the system function while stepping
+        double method_time;     // Seconds in the method outside the system function
+        double dv_min;          // Smallest and largest accepted steps
+        double dv_max;
+        double dv_sum;
+        std::array<size_t, scale_bins> scales; // Step size changes proposed by the controller
+};
+
+// The statistics type of an instrumentation policy
+template<typename Policy>
+struct Statistics { using type = IntegratorStatistics; };
+
+template<>
+struct Statistics<instrument::Detailed> { using type = DetailedStatistics; };
+
+//
+// The system function of the stepper, timed into its accumulator.  The function is held by
+//  reference, so the timed step evaluates the same function object as the rest of the stepper.
+//
+template<typename Func>
+struct TimedFunction
+{
+        using clock_t = std::chrono::steady_clock;
+
+        struct Timer
+        {
+                explicit Timer(clock_t::duration* _elapsed) : elapsed(_elapsed), start(clock_t::now()) {}
+                ~Timer() { *elapsed += clock_t::now() - start; }
+
+                clock_t::duration* elapsed;
+                clock_t::time_point start;
+        };
+
+        TimedFunction(Func& _func, clock_t::duration* _elapsed) : func(_func), elapsed(_elapsed) {}
+
+        template<typename... Args>
+        auto operator() (Args&&... args) -> decltype(std::declval<Func&>()(std::forward<Args>(args)...)) {
+            Timer timer(elapsed);
+            return func(std::forward<Args>(args)...);
+        }
+
+        Func& func;
+        clock_t::duration* elapsed;
+};
+
+// The functions of the stepper with the system function timed and the others by reference
+template<typename Funcs, size_t... Is>
+auto timedFunctions(Funcs& funcs, std::chrono::steady_clock::duration* elapsed, std::index_sequence<Is...>) {
+    using func_t = std::tuple_element_t<0, Funcs>;
+    return std::tuple<TimedFunction<func_t>, std::tuple_element_t<Is+1, Funcs>&...>(
+        TimedFunction<func_t>(std::get<0>(funcs), elapsed), std::get<Is+1>(funcs)...
+    );
+}
+
+//
+// Instrumenters take the steps of a stepper, passing the functions to the method and recording
+//  the statistics of the step which are not returned by the method.
+//
+template<typename Policy, typename Funcs>
+class Instrumenter;
+
+template<typename Funcs>
+class Instrumenter<instrument::Counters, Funcs>
+{
+    public:
+        using stats_t = typename Statistics<instrument::Counters>::type;
+
+        explicit Instrumenter(const Funcs&) {}
+
+        template<typename Step>
+        auto step(Funcs& funcs, stats_t&, Step step) { return step(funcs); }
+};
+
+template<typename Funcs>
+class Instrumenter<instrument::Detailed, Funcs>
+{
+    public:
+        using stats_t = typename Statistics<instrument::Detailed>::type;
+        using clock_t = std::chrono::steady_clock;
+
+        explicit Instrumenter(const Funcs&) : system(clock_t::duration::zero()) {}
+
+        template<typename Step>
+        auto step(Funcs& funcs, stats_t& stats, Step step) {
+            using seconds_t = std::chrono::duration<double>;
+
+            system = clock_t::duration::zero();
+            auto timed = timedFunctions(funcs, &system, std::make_index_sequence<std::tuple_size<Funcs>::value - 1>{});
+            const auto start = clock_t::now();
+            auto result = step(timed);
+            const auto total = clock_t::now() - start;
+
+            stats.system_time += std::chrono::duration_cast<seconds_t>(system).count();
+            stats.method_time += std::chrono::duration_cast<seconds_t>(total - system).count();
+            stats.iterations += result.iterations;
+            stats.stepped(static_cast<double>(result.dv), static_cast<double>(result.dv_next));
+            return result;
+        }
+
+    protected:
+        clock_t::duration system; // Time in the system function during the current step
+};
+
+} /*namespace internal*/
+} /*namespace epode*/
+
+#endif // EPODE_INSTRUMENT_H
@@ -19,34 +19,25 @@
 
 #include <iostream>
 #include <initializer_list>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
 #include <cmath>
 
 #include "core.h"
+#include "dense.h"
+#include "events.h"
+#include "output.h"
 #include "step.h"
+#include "stepper.h"
+#include "trace.h"
 #include "triggers.h"
 
 namespace epode
 {
 namespace internal
 {
-struct IntegratorStatistics
-{
-        IntegratorStatistics() : steps(0), evals(0) {}
-        IntegratorStatistics(const IntegratorStatistics& _other)
-            : steps(_other.steps), evals(_other.evals) {}
-
-        IntegratorStatistics& update(size_t _steps, size_t _evals ) {
-            steps += _steps;
-            evals += _evals;
-            return *this;
-        }
-
-        size_t steps;
-        size_t evals;
-};
-
 struct NullOutputTransformer
 {
         template<typename Value, typename State, typename Stats>
@@ -61,7 +52,8 @@ struct NullOutputTransformer
 };
 } /*namespace internal*/
 
-template<typename Value, size_t N, template<typename V, size_t N2> class Method>
+template<typename Value, size_t N, template<typename V, size_t N2> class Method,
+         typename Instrumentation = instrument::Counters>
 class Integrator
 {
     public:
@@ -71,33 +63,28 @@ class Integrator
 
     protected:
         using limits_t = step::StepLimits<value_t>;
-        using stats_t = internal::IntegratorStatistics;
+        using stats_t = typename internal::Statistics<Instrumentation>::type;
 
     public:
-		template<typename Results>
-		struct IntegratorLoopState
-		{
-			value_t dv;
-			value_t v;
-			state_t y;
-			stats_t stats = stats_t{};
-			Results results;
-			limits_t limits;
-			method_t method;
-			bool complete = false;
-		};
-
-		template<typename... Args>
+        template<typename Funcs>
+        using stepper_t = Stepper<value_t, N, Method, decltype(internal::Functions(std::declval<Funcs>())), Instrumentation>;
+
+        // An initial step size of zero (or none) is estimated from the system when integration starts
+        Integrator() : dv0(value_t(0)), method() {}
+
+        template<typename... Args>
         Integrator(value_t _dv0, Args... args) : dv0(_dv0), method(args...) {}
 
-        template<typename Funcs, typename YState, typename Transformer=internal::NullOutputTransformer>
+        template<typename Funcs, typename YState, typename Output=output::Every,
+                 typename Transformer=internal::NullOutputTransformer,
+                 typename = std::enable_if_t<output::internal::isOutputSpec<Output>::value> >
         auto operator() (Funcs funcs,
                              value_t v0,
                              std::initializer_list<value_t> _end,
                              YState y0,
+                             const Output& output = Output{},
                              const Transformer& transformer = Transformer{}) {
             auto end = triggers::internal::constructEndTrigger<value_t>(_end);
-            auto store = [](auto, auto, auto, auto) {return true;};
             auto limiter = step::internal::constructLimiter<limits_t, value_t>(_end);
 
             return this->operator ()(
@@ -105,164 +92,176 @@ class Integrator
                 v0, // Initial Integration Variable Value
                 y0, // Initial State Value
                 end, // Integration End Trigger
-                store, // Integration Step Store Trigger
+                output, // Output Specification
                 limiter,
+                events::internal::NullDetector{}, // No Events
                 transformer // Storage Transformer Type
             );
         }
 
-        template<typename Funcs, typename Ender, typename YState, typename Transformer=internal::NullOutputTransformer>
+        template<typename Funcs, typename Ender, typename YState, typename Output=output::Every,
+                 typename Transformer=internal::NullOutputTransformer,
+                 typename = std::enable_if_t<output::internal::isOutputSpec<Output>::value> >
         auto operator() (Funcs funcs, value_t v0, Ender _end, YState y0,
+                             const Output& output = Output{},
                              const Transformer& transformer = Transformer{}) {
-            auto end = triggers::internal::constructEndTrigger<value_t>(_end);
-            auto store = [](auto, auto, auto, auto) {return true;};
-            auto limiter = step::internal::constructLimiter<limits_t, value_t>(_end);
+            auto end = triggers::internal::constructEndTrigger<value_t>(events::internal::endOf(_end));
+            auto limiter = step::internal::constructLimiter<limits_t, value_t>(events::internal::endOf(_end));
+            auto detector = makeDetector(_end);
 
             return this->operator ()(
                 internal::Functions(funcs), // Ensure that a single function is wrapped
                 v0, // Initial Integration Variable Value
                 y0, // Initial State Value
                 end, // Integration End Trigger
-                store, // Integration Step Store Trigger
+                output, // Output Specification
                 limiter,
+                detector, // Event Detector
                 transformer // Storage Transformer Type
             );
         }
 
-		template<typename Funcs, typename Transformer>
-		auto initializeLoopState(
-			Funcs funcs,
-			value_t v0, state_t y0,
-			Transformer transformer) {
-			using transformed_state_t = decltype(transformer(value_t{}, value_t{}, state_t{}, stats_t{}));
-			using point_t = internal::StepPoint<value_t, transformed_state_t, stats_t>;
-			using results_t = std::vector<point_t>;
-
-			IntegratorLoopState<results_t> state;
-			state.dv = dv0;
-			state.v = v0;
-			state.y = y0;
-			state.method = method; // COPY FROM THE CONSTRUCTED METHOD
-
-
-			auto f0 = std::get<0>(funcs);
-			initMethod(state.dv, state.v, state.y, f0, state.method);
-
-			return state;
-		}
-
-    template<typename Results, typename DerivFunc, typename Storer, typename Limiter, typename Transformer>
-    auto loopIteration ( IntegratorLoopState<Results> _state, DerivFunc f0, Storer _store, Limiter _limiter, Transformer _transformer) {
-		// Always constrain the integration variable step
-		_state.dv = _state.limits.constrain(_state.dv);
-
-		// Do a step of the selected integration method and update the integration state
-		const auto result = _state.method(f0, _state.dv, _state.v, _state.y, _state.limits);
-		_state.v += result.dv;
-		_state.dv = result.dv_next;
-		_state.y = result.y;
-		_state.stats.update(1, result.evals);
-
-		if(_store(result.dv, _state.v, _state.y, _state.stats)){
-			const auto y_transformed = _transformer(result.dv, _state.v, _state.y, _state.stats);
-			_state.results.emplace_back(result.dv, _state.v, y_transformed, _state.stats);
-		}
-
-		// Update the integration variable limits
-		_state.limits = _limiter(_state.dv, _state.v);
-		return _state;
-    }
+        // Store every step with an output transformer
+        template<typename Funcs, typename Ender, typename YState, typename Transformer,
+                 typename = std::enable_if_t<!output::internal::isOutputSpec<Transformer>::value> >
+        auto operator() (Funcs funcs, value_t v0, Ender _end, YState y0, const Transformer& transformer) {
+            return this->operator ()(funcs, v0, _end, y0, output::steps(), transformer);
+        }
 
-    protected:
         //
-        // These overloads determine if the integration method object has an init member function
-        //  and, if so, it calls it.
+        // Continue the integration held by a stepper (see stepper()) until the end trigger fires.
+        //  The method is not re-initialized, so integration resumes exactly where the stepper
+        //  last stopped.
         //
-        template<typename V, typename S, typename... Ts>
-        void initMethod(V, V, S, Ts...) {}
+        template<typename Funcs, typename Ender, typename Output=output::Every,
+                 typename Transformer=internal::NullOutputTransformer>
+        auto operator() (Stepper<value_t, N, Method, Funcs, Instrumentation>& stepper, Ender _end,
+                             const Output& output = Output{},
+                             const Transformer& transformer = Transformer{}) {
+            auto end = triggers::internal::constructEndTrigger<value_t>(events::internal::endOf(_end));
+            auto limiter = step::internal::constructLimiter<limits_t, value_t>(events::internal::endOf(_end));
+            return run(stepper, end, output, limiter, transformer, makeDetector(_end));
+        }
 
-        template<typename V, typename S, typename Func, typename Method>
-        auto initMethod(V dv, V v, S y, Func _func, Method& _method)
-        -> decltype(_method.init(dv, v, y, _func)) {
-            return _method.init(dv, v, y, _func);
+        //
+        // Integrate the system and store results only at the requested values of the integration
+        //  variable (which must be in ascending order).  The results are produced from the dense
+        //  output of the method, so the step size is chosen by the method alone and sampling does
+        //  not require any additional function evaluations.
+        //
+        template<typename Funcs, typename Ender, typename YState, typename Abscissae,
+                 typename Transformer=internal::NullOutputTransformer>
+        auto sample(Funcs funcs, value_t v0, Ender _end, YState y0, const Abscissae& vs,
+                    const Transformer& transformer = Transformer{}) {
+            static_assert(
+                internal::hasDenseOutput<method_t>::value,
+                "Integrator::sample() requires an integration method which provides dense output."
+            );
+            return this->operator ()(funcs, v0, _end, y0, output::at(vs), transformer);
+        }
+
+        template<typename Funcs, typename Ender, typename YState,
+                 typename Transformer=internal::NullOutputTransformer>
+        auto sample(Funcs funcs, value_t v0, Ender _end, YState y0, std::initializer_list<value_t> vs,
+                    const Transformer& transformer = Transformer{}) {
+            return sample<Funcs, Ender, YState, std::initializer_list<value_t>, Transformer>(
+                funcs, v0, _end, y0, vs, transformer
+            );
         }
 
         //
-        // The generic call operator which contains the implementaion.
+        // Construct and initialize a stepper for the system which may then be advanced manually
+        //  or passed back into the integrator to continue the integration.
         //
-        template<typename Funcs, typename Ender, typename Storer, typename Limiter, typename Transformer>
-        auto operator() (
-                Funcs funcs,
-                value_t v0, state_t y0,
-                Ender end, Storer store, Limiter limiter,
-                Transformer transformer) {
+        template<typename Funcs, typename YState>
+        auto stepper(Funcs funcs, value_t v0, YState y0) {
+            auto s = stepper_t<Funcs>(internal::Functions(funcs), method, dv0);
+            s.init(v0, y0);
+            return s;
+        }
+
+        //
+        // A single in-place iteration of the integration loop.  The stepper is advanced and the
+        //  recorder of the output specification stores any results which the step produced.
+        //
+        template<typename S, typename Results, typename Recorder, typename Limiter, typename Transformer>
+        void loopIteration(S& stepper, Results& results, Recorder& recorder, Limiter _limiter, Transformer& _transformer) {
+            auto detector = events::internal::NullDetector{};
+            loopIteration(stepper, results, recorder, _limiter, _transformer, detector);
+        }
+
+        //
+        // As above, locating the events of the step with the detector.  A terminating event moves
+        //  the end of the step back to the event before the step is recorded.  The step is also
+        //  recorded in the timeline of an open trace::Session.
+        //
+        template<typename S, typename Results, typename Recorder, typename Limiter, typename Transformer,
+                 typename Detector>
+        void loopIteration(S& stepper, Results& results, Recorder& recorder, Limiter _limiter, Transformer& _transformer,
+                           Detector& detector) {
+            const auto dv_taken = trace::internal::step(stepper, [&] { return stepper.step(_limiter); });
+            if(stepper.failed()) return; // There is no step to record
+
+            const auto dv = detector.locate(stepper, dv_taken);
+            recorder.stepped(stepper, results, _transformer, dv);
+            detector.record(stepper, results, _transformer, dv);
+        }
 
-            /*using transformed_state_t = decltype(transformer(value_t{}, value_t{}, state_t{}, stats_t{}));
+    protected:
+        template<typename Transformer>
+        static auto makeResults(const Transformer& transformer) {
+            using transformed_state_t = decltype(transformer(value_t{}, value_t{}, state_t{}, stats_t{}));
             using point_t = internal::StepPoint<value_t, transformed_state_t, stats_t>;
-            using return_t = std::vector<point_t>;
-
-            return_t results;
-
-            auto stats = stats_t(); // Create inital statistics object
-
-            auto dv = dv0;
-            auto f0 = std::get<0>(funcs);
-            auto y = y0;
-            auto v = v0;
-			//std::cout << "y0 = " << y0 << '\n';
-			//std::cout << "y = " << y << '\n';
-            initMethod(dv, v, y, f0, method);
-			//std::cout << "y (after init) = " << y << '\n';
-
-            auto limits = limiter(dv, v);
-
-            while(!end(dv, v, y, stats, limits)){
-                // Always constrain the integration variable step
-                dv = limits.constrain(dv);
-
-                // Do a step of the selected integration method and update the integration state
-                const auto result = method(f0, dv, v, y, limits);
-                v += result.dv;
-                dv = result.dv_next;
-                y = result.y;
-				//std::cout << "y (first iteration) = " << y << '\n';
-				//exit(-1);
-				stats.update(1, result.evals);
-				//std::cout << "dv = " << dv << "\n";
-
-                if(std::isnan(dv)) {
-                    std::cout << "limits = [" << limits.min << ", " << limits.max << "], dv = " << result.dv << std::endl;
-                    std::cout << "steps = " << stats.steps << ", evals = " << stats.evals << std::endl;
-                    exit(-1);
-                }
-
-                // Store the correctly transformed results of the step, if desired
-                //  TODO: IT MAKES SENSE TO CONSIDER INTERPOLATION HERE....
-                //  INTERPOLATION WILL, LIKELY, REQUIRE A REVAMPING OF THE METHOD API TO RETURN
-                //  MORE DATA, BUT, IT WOULD MAKE IT POSSIBLE TO GET A DENSE OUTPUT WITH LESS
-                //  COMPUTATIONAL EFFORT -- NOT A BAD THING.  AS A BASE LINE, IT WOULD BE POSSIBLE
-                //  TO DO A THIRD ORDER INTERPOLATION USING JUST THE BEGIN AND END POINTS AND THEIR
-                //  SLOPES.  WITH THE MID-POINT ALSO, IT WOULD BE POSSIBLE TO DO A QUARTIC
-                //  (4TH ORDER) INTERPOLATION.  IT SEEMS THAT THESE TWO OPTIONS ARE REASONABLE TO
-                //  CONSIDER AND IMPLEMENT (AS A START). THERE NEEDS TO BE API IN PLACE TO CONTROL
-                //  THE DENSITY OF THE OUTPUT THOUGH....
-                if(store(result.dv, v, y, stats)){
-                    const auto y_transformed = transformer(result.dv, v, y, stats);
-                    results.emplace_back(result.dv, v, y_transformed, stats);
-                }
-
-                // Update the integration variable limits
-                limits = limiter(dv, v);
-            }*/
-			auto f0 = std::get<0>(funcs);
-
-            auto state = initializeLoopState(funcs, v0, y0, transformer);
-
-            while(!end(state.dv, state.v, state.y, state.stats, state.limits)) {
-              state = loopIteration(state, f0, store, limiter, transformer);
+            return std::vector<point_t>{};
+        }
+
+        template<typename Ender>
+        static auto makeDetector(const Ender& _end) {
+            return events::internal::makeDetector<value_t, state_t, internal::hasDenseOutput<method_t>::value>(_end);
+        }
+
+        template<typename S, typename Ender, typename Output, typename Limiter, typename Transformer, typename Detector>
+        auto run(S& stepper, Ender end, const Output& output, Limiter limiter, const Transformer& transformer,
+                 Detector detector) {
+            auto results = makeResults(transformer);
+            auto recorder = output::internal::makeRecorder<method_t>(output);
+            auto limit = [&](auto dv, auto v) { return recorder.limit(limiter(dv, v), v); };
+
+            recorder.reserve(results);
+            recorder.start(stepper, results, transformer);
+
+            stepper.limit(limit);
+            detector.start(stepper);
+            while(!end(stepper.dv(), stepper.v(), stepper.y(), stepper.stats(), stepper.limits())) {
+                loopIteration(stepper, results, recorder, limit, transformer, detector);
+                if(detector.terminated() || stepper.failed()) break;
+            }
+
+            // The exit status is kept in the statistics of the last result
+            if(detector.terminated()) {
+                stepper.finish(Status::Event);
+            } else if(!stepper.failed()) {
+                stepper.finish(triggers::internal::exitStatus(
+                    end, stepper.dv(), stepper.v(), stepper.y(), stepper.stats(), stepper.limits()
+                ));
             }
+            recorder.finish(stepper, results, transformer);
+            if(!results.empty()) results.back().stats.status = stepper.stats().status;
+            return results;
+        }
 
-            return state.results;
+        //
+        // The generic call operator which contains the implementaion.
+        //
+        template<typename Funcs, typename Ender, typename Output, typename Limiter, typename Detector,
+                 typename Transformer>
+        auto operator() (
+                Funcs funcs,
+                value_t v0, state_t y0,
+                Ender end, const Output& output, Limiter limiter, Detector detector,
+                const Transformer& transformer) {
+            auto s = stepper(funcs, v0, y0);
+            return run(s, end, output, limiter, transformer, detector);
         }
 
         //
@@ -0,0 +1,119 @@
+//
+//
+// File - Epode/nordsieck.h:
+//
+//      The Nordsieck history array shared by the variable-order multistep methods.  The history
+//  of the solution is kept as the array of scaled derivatives,
+//
+//          z[j] = (dv^j / j!) * d^j y / dv^j,   j = 0, ..., q
+//
+//  in preallocated buffers.  A step predicts z by Taylor expansion (the Pascal matrix), a step
+//  size change by a ratio eta scales z[j] by eta^j, and an order change extends or truncates the
+//  array.  None of these operations allocate or need the past step sizes.
+//
+//
+// License:
+//
+//      This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0.
+//  If a copy of the MPL was not distributed with this file, You can obtain one
+//  at http://mozilla.org/MPL/2.0/.
+//
+//
+
+#ifndef EPODE_NORDSIECK_H
+#define EPODE_NORDSIECK_H
+
+#include <array>
+
+#include "core.h"
+#include "dense.h"
+
+namespace epode
+{
+namespace internal
+{
+
+//
+// The history holds one column more than the maximum order, so that the order can be raised.
+//
+template<typename Value, size_t N, size_t MaxOrder>
+class NordsieckHistory
+{
+    public:
+        using value_t = Value;
+        using state_t = State<value_t, N>;
+        using dense_t = DenseOutput<value_t, state_t, MaxOrder>;
+
+        static constexpr size_t max_order = MaxOrder;
+
+        state_t& operator [] (size_t j) { return z[j]; }
+        const state_t& operator [] (size_t j) const { return z[j]; }
+
+        // Start a first order history at y0, with z[1] = dv*f0
+        void reset(value_t dv, const state_t& y0, const state_t& f0) {
+            z[0] = y0;
+            z[1] = dv * f0;
+            for(size_t j = 2; j < z.size(); ++j) z[j].setZero(y0.size());
+        }
+
+        // Rescale the order q history (and the spare column) for a step ratio eta
+        void rescale(size_t q, value_t eta) {
+            auto factor = eta;
+            for(size_t j = 1; j <= q + 1; ++j) {
+                z[j] *= factor;
+                factor *= eta;
+            }
+        }
+
+        // Taylor series prediction of the history, z := P*z with the Pascal matrix P
+        void predict(size_t q) {
+            for(size_t k = 0; k < q; ++k) {
+                for(size_t j = q; j > k; --j) {
+                    z[j-1] += z[j];
+                }
+            }
+        }
+
+        // Undo the prediction after a failed step
+        void retract(size_t q) {
+            for(size_t k = q; k > 0; --k) {
+                for(size_t j = k; j <= q; ++j) {
+                    z[j-1] -= z[j];
+                }
+            }
+        }
+
+        //
+        // Dense output of the step of size dv ending at v from the interpolating polynomial,
+        //  y(v + x*dv) = sum_j z[j]*x^j with x = theta - 1, converted to powers of theta.
+        //
+        dense_t dense(value_t v, value_t dv, size_t q) const {
+            auto result = dense_t(v - dv, dv, z[0]);
+            for(size_t k = 0; k < max_order; ++k) {
+                result.r[k].setZero(z[0].size());
+            }
+
+            auto binomial = std::array<value_t, max_order + 1>{};
+            binomial[0] = value_t(1);
+            for(size_t j = 1; j <= q; ++j) {
+                // Coefficients of (theta - 1)^j
+                for(size_t k = j; k > 0; --k) {
+                    binomial[k] = binomial[k-1] - binomial[k];
+                }
+                binomial[0] = -binomial[0];
+                result.y0 += binomial[0] * z[j];
+                for(size_t k = 1; k <= j; ++k) {
+                    result.r[k-1] += binomial[k] * z[j];
+                }
+            }
+            return result;
+        }
+
+    protected:
+        std::array<state_t, max_order + 2> z;
+};
+
+} /*namespace internal*/
+} /*namespace epode*/
+
+#endif // EPODE_NORDSIECK_H
@@ -20,16 +20,27 @@
 // Core Files
 //
 #include "core.h"
+#include "dense.h"
+#include "events.h"
+#include "output.h"
 #include "util.h"
 
 //
 // Solver Methods
 //
+#include "adams.h"
 #include "butcher.h"
 #include "bogacki_shampine.h"
+#include "dormand_prince.h"
 #include "euler.h"
+#include "explicit_rk.h"
 #include "rkf.h"
 #include "rk2.h"
+#include "bdf.h"
+#include "radau.h"
+#include "rosenbrock.h"
+#include "sparse.h"
+#include "autodiff.h"
 
 //
 // Compositional Triggers
@@ -41,6 +52,9 @@
 // Integrator Wrapper and associated classes
 //
 #include "step.h"
+#include "instrument.h"
+#include "trace.h"
+#include "stepper.h"
 #include "integrator.h"
 
 //
@@ -91,10 +105,45 @@ using RKF45 = Integrator<Value, N, method::RKF45>;
 template<typename Value, size_t N>
 using BS45 = Integrator<Value, N, method::BS45>;
 
+template<typename Value, size_t N>
+using DP45 = Integrator<Value, N, method::DP45>;
+
 // Fifth-Order Integrators
 template<typename Value, size_t N>
 using Butcher5th = Integrator<Value, N, method::Butcher5th>;
 
+// Eighth-Order Integrators
+template<typename Value, size_t N>
+using DOP853 = Integrator<Value, N, method::DOP853>;
+
+// Variable-Order (Multistep) Integrators
+template<typename Value, size_t N>
+using ABM = Integrator<Value, N, method::ABM>;
+
+// Stiff (Linearly Implicit) Integrators
+template<typename Value, size_t N>
+using Ros3 = Integrator<Value, N, method::Ros3>;
+
+template<typename Value, size_t N>
+using Rodas3 = Integrator<Value, N, method::Rodas3>;
+
+template<typename Value, size_t N>
+using Rodas4 = Integrator<Value, N, method::Rodas4>;
+
+// Stiff (Implicit) Integrators
+template<typename Value, size_t N>
+using Radau5 = Integrator<Value, N, method::Radau5>;
+
+template<typename Value, size_t N>
+using BDF = Integrator<Value, N, method::BDF>;
+
+// Stiff (Implicit) Integrators with Sparse Jacobians
+template<typename Value, size_t N>
+using SparseRadau5 = Integrator<Value, N, method::SparseRadau5>;
+
+template<typename Value, size_t N>
+using SparseBDF = Integrator<Value, N, method::SparseBDF>;
+
 } /*namespace integrator*/
 } /*namespace epode*/
 
@@ -103,5 +152,15 @@ using Butcher5th = Integrator<Value, N, method::Butcher5th>;
 //
 #include "solve.h"
 
+//
+// Import the multithreaded "ensemble" driver for parameter sweeps
+//
+#include "ensemble.h"
+
+//
+// Lockstep batched integration of many small systems
+//
+#include "batch.h"
+
 #endif /*EPODE_ODE_H*/
 
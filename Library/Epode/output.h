@@ -0,0 +1,325 @@
+//
+//
+// File - Epode/output.h:
+//
+//      Output specifications which control which results an integration stores.  The density of
+//  the output is independent of the density of the integration steps: results may be stored at
+//  every k-th step, at the steps where a trigger fires, on a uniform grid or at an explicit list
+//  of sample points.  The grid and list specifications know their size in advance, so the
+//  results container is reserved once and never reallocates.
+//
+//      When the integration method provides dense output, samples are interpolated from the step
+//  which contains them.  Otherwise, the steps are limited so that they land on the sample points.
+//
+//
+// License:
+//
+//      This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0.
+//  If a copy of the MPL was not distributed with this file, You can obtain one
+//  at http://mozilla.org/MPL/2.0/.
+//
+//
+
+#ifndef EPODE_OUTPUT_H
+#define EPODE_OUTPUT_H
+
+#include <algorithm>
+#include <cmath>
+#include <initializer_list>
+#include <iterator>
+#include <limits>
+#include <type_traits>
+#include <vector>
+
+#include "dense.h"
+
+namespace epode
+{
+namespace output
+{
+
+// Store every k-th accepted step, and the final step
+class Every
+{
+    public:
+        explicit Every(size_t _k = 1) : k((_k == 0) ? 1 : _k) {}
+
+        size_t k;
+};
+
+// Store n points uniformly spaced from v0 to v1 (inclusive)
+template<typename Value>
+class Uniform
+{
+    public:
+        using value_t = Value;
+
+        Uniform(value_t _v0, value_t _v1, size_t _n) : v0(_v0), v1(_v1), n(_n) {}
+
+        size_t size() const { return n; }
+
+        value_t operator[] (size_t idx) const {
+            if(n < 2) return v0;
+            if(idx == n-1) return v1;
+            return v0 + ((v1 - v0) * value_t(idx)) / value_t(n-1);
+        }
+
+        value_t v0;
+        value_t v1;
+        size_t n;
+};
+
+// Store at an explicit list of points (in ascending order)
+template<typename Value>
+class List
+{
+    public:
+        using value_t = Value;
+
+        template<typename Iter>
+        List(Iter begin, Iter end) : vs(begin, end) {}
+
+        size_t size() const { return vs.size(); }
+        value_t operator[] (size_t idx) const { return vs[idx]; }
+
+        std::vector<value_t> vs;
+};
+
+// Store the steps at which a trigger fires (see triggers.h), and the final step
+template<typename Trigger>
+class When
+{
+    public:
+        explicit When(const Trigger& _trigger) : trigger(_trigger) {}
+
+        Trigger trigger;
+};
+
+//
+// Output specification construction functions
+//
+inline Every steps() { return Every(1); }
+
+inline Every every(size_t k) { return Every(k); }
+
+template<typename Value>
+Uniform<Value> uniform(Value v0, Value v1, size_t n) { return Uniform<Value>(v0, v1, n); }
+
+template<typename Value>
+List<Value> at(std::initializer_list<Value> vs) { return List<Value>(vs.begin(), vs.end()); }
+
+template<typename Range>
+auto at(const Range& vs) {
+    using value_t = typename std::decay<decltype(*std::begin(vs))>::type;
+    return List<value_t>(std::begin(vs), std::end(vs));
+}
+
+template<typename Trigger>
+When<Trigger> when(const Trigger& trigger) { return When<Trigger>(trigger); }
+
+namespace internal
+{
+template<typename T>
+struct isOutputSpec : std::false_type {};
+
+template<>
+struct isOutputSpec<Every> : std::true_type {};
+
+template<typename Value>
+struct isOutputSpec<Uniform<Value>> : std::true_type {};
+
+template<typename Value>
+struct isOutputSpec<List<Value>> : std::true_type {};
+
+template<typename Trigger>
+struct isOutputSpec<When<Trigger>> : std::true_type {};
+
+//
+// Recorders implement an output specification for a single integration.  The integrator calls
+//  reserve() and start() before the first step, limit() whenever the step limits are updated,
+//  stepped() after every step and finish() after the end trigger fires.
+//
+template<typename Value>
+class EveryRecorder
+{
+    public:
+        using value_t = Value;
+
+        explicit EveryRecorder(const Every& _spec) : k(_spec.k), count(0), stored(true) {}
+
+        template<typename Results>
+        void reserve(Results&) const {}
+
+        template<typename Stepper, typename Results, typename Transformer>
+        void start(const Stepper&, Results&, const Transformer&) {}
+
+        template<typename Limits>
+        const Limits& limit(const Limits& limits, value_t) const { return limits; }
+
+        template<typename Stepper, typename Results, typename Transformer>
+        void stepped(const Stepper& s, Results& results, const Transformer& transformer, value_t dv) {
+            count += 1;
+            stored = (count % k) == 0;
+            if(stored) {
+                results.emplace_back(dv, s.v(), transformer(dv, s.v(), s.y(), s.stats()), s.stats());
+            }
+            dv_last = dv;
+        }
+
+        template<typename Stepper, typename Results, typename Transformer>
+        void finish(const Stepper& s, Results& results, const Transformer& transformer) {
+            if(!stored) {
+                results.emplace_back(dv_last, s.v(), transformer(dv_last, s.v(), s.y(), s.stats()), s.stats());
+                stored = true;
+            }
+        }
+
+    protected:
+        size_t k;
+        size_t count;
+        bool stored;
+        value_t dv_last = value_t(0);
+};
+
+//
+// Store the steps at which the trigger fires.  The trigger is called like an end trigger.
+//
+template<typename Value, typename Trigger>
+class WhenRecorder
+{
+    public:
+        using value_t = Value;
+
+        explicit WhenRecorder(const When<Trigger>& _spec) : trigger(_spec.trigger), stored(true) {}
+
+        template<typename Results>
+        void reserve(Results&) const {}
+
+        template<typename Stepper, typename Results, typename Transformer>
+        void start(const Stepper&, Results&, const Transformer&) {}
+
+        template<typename Limits>
+        const Limits& limit(const Limits& limits, value_t) const { return limits; }
+
+        template<typename Stepper, typename Results, typename Transformer>
+        void stepped(const Stepper& s, Results& results, const Transformer& transformer, value_t dv) {
+            stored = trigger(dv, s.v(), s.y(), s.stats(), s.limits());
+            if(stored) {
+                results.emplace_back(dv, s.v(), transformer(dv, s.v(), s.y(), s.stats()), s.stats());
+            }
+            dv_last = dv;
+        }
+
+        template<typename Stepper, typename Results, typename Transformer>
+        void finish(const Stepper& s, Results& results, const Transformer& transformer) {
+            if(!stored) {
+                results.emplace_back(dv_last, s.v(), transformer(dv_last, s.v(), s.y(), s.stats()), s.stats());
+                stored = true;
+            }
+        }
+
+    protected:
+        Trigger trigger;
+        bool stored;
+        value_t dv_last = value_t(0);
+};
+
+//
+// Store samples at a sequence of points.  With dense output the samples are interpolated,
+//  otherwise the step limits are reduced so that steps land exactly on the sample points.
+//
+template<typename Points, bool Dense>
+class SampleRecorder
+{
+    public:
+        using value_t = typename Points::value_t;
+
+        explicit SampleRecorder(const Points& _points) : points(_points), idx(0) {}
+
+        template<typename Results>
+        void reserve(Results& results) const { results.reserve(points.size()); }
+
+        template<typename Stepper, typename Results, typename Transformer>
+        void start(const Stepper& s, Results& results, const Transformer& transformer) {
+            for(; (idx < points.size()) && (points[idx] <= s.v()); ++idx) {
+                if(points[idx] == s.v()) {
+                    results.emplace_back(value_t(0), s.v(), transformer(value_t(0), s.v(), s.y(), s.stats()), s.stats());
+                }
+            }
+        }
+
+        template<typename Limits>
+        Limits limit(Limits limits, value_t v) const {
+            if(!Dense && (idx < points.size())) {
+                limits.max = std::min(limits.max, points[idx] - v);
+            }
+            return limits;
+        }
+
+        template<typename Stepper, typename Results, typename Transformer>
+        void stepped(Stepper& s, Results& results, const Transformer& transformer, value_t dv) {
+            emit(std::integral_constant<bool, Dense>{}, s, results, transformer, dv, s.v());
+            dv_last = dv;
+        }
+
+        template<typename Stepper, typename Results, typename Transformer>
+        void finish(Stepper& s, Results& results, const Transformer& transformer) {
+            // The end trigger considers the integration complete within the minimum step of the
+            //  end value, so samples in that window are taken from the final step as well.
+            if(Dense && (dv_last != value_t(0))) {
+                emit(std::integral_constant<bool, Dense>{}, s, results, transformer, dv_last, s.v() + s.limits().min);
+            }
+        }
+
+    protected:
+        template<typename Stepper, typename Results, typename Transformer>
+        void emit(std::true_type, Stepper& s, Results& results, const Transformer& transformer,
+                  value_t dv, value_t v) {
+            using state_t = typename Stepper::state_t;
+            if((idx == points.size()) || (points[idx] > v)) return;
+
+            const auto interpolant = s.dense();
+            for(; (idx < points.size()) && (points[idx] <= v); ++idx) {
+                const auto vi = points[idx];
+                const state_t y = interpolant(vi);
+                results.emplace_back(dv, vi, transformer(dv, vi, y, s.stats()), s.stats());
+            }
+        }
+
+        template<typename Stepper, typename Results, typename Transformer>
+        void emit(std::false_type, const Stepper& s, Results& results, const Transformer& transformer,
+                  value_t dv, value_t v) {
+            // Steps are limited to end on the next sample point, up to rounding of the step size
+            const auto eps = value_t(64) * std::numeric_limits<value_t>::epsilon();
+            for(; (idx < points.size()) && (points[idx] <= v + eps*std::max(std::abs(v), value_t(1))); ++idx) {
+                const auto vi = points[idx];
+                results.emplace_back(dv, vi, transformer(dv, vi, s.y(), s.stats()), s.stats());
+            }
+        }
+
+        Points points;
+        size_t idx;
+        value_t dv_last = value_t(0);
+};
+
+template<typename Method>
+auto makeRecorder(const Every& spec) { return EveryRecorder<typename Method::value_t>(spec); }
+
+template<typename Method, typename Value>
+auto makeRecorder(const Uniform<Value>& spec) {
+    return SampleRecorder<Uniform<Value>, epode::internal::hasDenseOutput<Method>::value>(spec);
+}
+
+template<typename Method, typename Trigger>
+auto makeRecorder(const When<Trigger>& spec) { return WhenRecorder<typename Method::value_t, Trigger>(spec); }
+
+template<typename Method, typename Value>
+auto makeRecorder(const List<Value>& spec) {
+    return SampleRecorder<List<Value>, epode::internal::hasDenseOutput<Method>::value>(spec);
+}
+} /*namespace internal*/
+
+} /*namespace output*/
+} /*namespace epode*/
+
+#endif // EPODE_OUTPUT_H
@@ -0,0 +1,356 @@
+//
+//
+// File - Epode/radau.h:
+//
+//      Implementation of the three stage Radau IIA method of order 5 for stiff systems, following
+//  RADAU5 (Hairer & Wanner, "Solving Ordinary Differential Equations II", section IV.8).  The
+//  stage equations are solved by a simplified Newton iteration in which the Runge-Kutta matrix
+//  is transformed to block diagonal form, so that each iteration needs one real and one complex
+//  linear solve of size N instead of one real solve of size 3N.
+//
+//      The Jacobian is reused over steps while the Newton iteration converges quickly and the
+//  factorizations are reused while the step size does not change, so that in smooth regions the
+//  cost of a step is dominated by the system function evaluations.  The number of Jacobian
+//  evaluations and factorizations is reported in the integrator statistics.
+//
+//      The collocation polynomial of the last step is available as dense output and is also used
+//  to predict the starting values of the Newton iteration in the following step.
+//
+//
+// License:
+//
+//      This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0.
+//  If a copy of the MPL was not distributed with this file, You can obtain one
+//  at http://mozilla.org/MPL/2.0/.
+//
+//
+
+#ifndef EPODE_RADAU_H
+#define EPODE_RADAU_H
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <tuple>
+
+#include "core.h"
+#include "dense.h"
+#include "implicit.h"
+#include "step.h"
+
+namespace epode
+{
+namespace method
+{
+
+// TODO: INCLUDE "SOLVING ORDINARY DIFFERENTIAL EQUATIONS II" (HAIRER & WANNER) IN THE DOCUMENTATION
+//
+// The linear algebra is selected by the Linearization class; use the Radau5 alias for the dense
+//  default (integrators require methods with exactly two template parameters).
+//
+template<typename Value, size_t N, template<typename V, size_t N2> class Linearization>
+class BasicRadau5 : public internal::ImplicitAdaptive<Value, 5>
+{
+    public:
+        using value_t = Value;
+        using state_t = internal::State<value_t, N>;
+        using return_t = internal::MethodReturnRef<value_t, state_t>;
+        using dense_t = internal::DenseOutput<value_t, state_t, 3>;
+        using linearization_t = Linearization<value_t, N>;
+
+        BasicRadau5(const Tolerance<value_t>& _tolerance = internal::defaultTolerance(1e-6, 5),
+                    const step::Controller<value_t>& _controller = step::Controller<value_t>())
+            : internal::ImplicitAdaptive<Value, 5>(_tolerance, _controller),
+              jacobian_current(false), factored_dv(0), have_history(false),
+              rejected(false), first(true), theta(0), faccon(1) {}
+
+        template<typename Funcs>
+        void init(value_t /*dv*/, value_t /*v0*/, const state_t& /*y0*/, Funcs /*funcs*/) {
+            jacobian_current = false;
+            factored_dv = value_t(0);
+            have_history = false;
+            rejected = false;
+            first = true;
+            faccon = value_t(1);
+            this->controller.reset();
+        }
+
+        template<typename Funcs, typename Limiter>
+        return_t operator () (Funcs& funcs, value_t dv, value_t v, const state_t& y0, Limiter limiter) {
+            // Collocation points
+            constexpr auto sq6 = value_t(2.4494897427831780981972840747059);
+            constexpr auto c1 = (value_t(4) - sq6) / value_t(10);
+            constexpr auto c2 = (value_t(4) + sq6) / value_t(10);
+            constexpr auto c1m1 = c1 - value_t(1);
+            constexpr auto c2m1 = c2 - value_t(1);
+            constexpr auto c1mc2 = c1 - c2;
+
+            // Error estimate weights
+            constexpr auto dd1 = -(value_t(13) + value_t(7)*sq6) / value_t(3);
+            constexpr auto dd2 = (value_t(-13) + value_t(7)*sq6) / value_t(3);
+            constexpr auto dd3 = value_t(-1) / value_t(3);
+
+            // Eigenvalues of the inverse Runge-Kutta matrix, u1 and alpha +/- i*beta
+            constexpr auto u1 = value_t(3.6378342527444957322);
+            constexpr auto alpha = value_t(2.6810828736277521339);
+            constexpr auto beta = value_t(3.0504301992474105694);
+
+            // Transformation to block diagonal form (T) and its inverse (TI)
+            constexpr auto t11 = value_t(9.1232394870892942792e-02);
+            constexpr auto t12 = value_t(-0.14125529502095420843);
+            constexpr auto t13 = value_t(-3.0029194105147424492e-02);
+            constexpr auto t21 = value_t(0.24171793270710701896);
+            constexpr auto t22 = value_t(0.20412935229379993199);
+            constexpr auto t23 = value_t(0.38294211275726193779);
+            constexpr auto t31 = value_t(0.96604818261509293619);
+            constexpr auto ti11 = value_t(4.3255798900631553510);
+            constexpr auto ti12 = value_t(0.33919925181580986954);
+            constexpr auto ti13 = value_t(0.54177053993587487119);
+            constexpr auto ti21 = value_t(-4.1787185915519047273);
+            constexpr auto ti22 = value_t(-0.32768282076106238708);
+            constexpr auto ti23 = value_t(0.47662355450055045196);
+            constexpr auto ti31 = value_t(-0.50287263494578687595);
+            constexpr auto ti32 = value_t(2.5719269498556054292);
+            constexpr auto ti33 = value_t(-0.59603920482822492497);
+
+            // Step control
+            constexpr size_t max_iterations = 7;
+            constexpr auto theta_reuse = value_t(0.001); // Keep the Jacobian below this contraction
+            constexpr auto reuse_max = value_t(1.2);     // Keep the step size (and LU) below this ratio
+            const auto eps = std::numeric_limits<value_t>::epsilon();
+            const auto fnewt = std::max(value_t(10)*eps/this->tolerance.bound(), value_t(0.03));
+
+            auto& func = std::get<0>(funcs);
+            size_t evals = 0;
+            size_t rejections = 0;
+            size_t jacobians = 0;
+            size_t decompositions = 0;
+            size_t jacobian_evals = 0;
+            size_t newton_iterations = 0;
+
+            internal::evaluate(func, v, y0, f0);
+            evals += 1;
+
+            // The last collocation polynomial only predicts a step which continues from its end
+            if(have_history && (v != v0_ + dv_)) have_history = false;
+
+            bool jacobian_fresh = !jacobian_current;
+            if(jacobian_fresh) {
+                jacobian_evals += linear.jacobian(funcs, v, y0, f0);
+                jacobians += 1;
+                jacobian_current = true;
+                factored_dv = value_t(0);
+            }
+
+            auto dv_next = dv;
+            bool done = false;
+
+            do {
+                dv = limiter.constrain(dv_next);
+                if(dv != factored_dv) {
+                    linear.factor(u1 / dv);
+                    linear.factor(alpha / dv, beta / dv);
+                    decompositions += 2;
+                    factored_dv = dv;
+                }
+
+                // Starting values for the stage increments: extrapolated from the collocation
+                //  polynomial of the last accepted step, or zero
+                if(have_history && !rejected) {
+                    const auto c3q = dv / dv_;
+                    const auto c1q = c1 * c3q;
+                    const auto c2q = c2 * c3q;
+                    z1 = c1q*(cont1 + (c1q - c2m1)*(cont2 + (c1q - c1m1)*cont3));
+                    z2 = c2q*(cont1 + (c2q - c2m1)*(cont2 + (c2q - c1m1)*cont3));
+                    z3 = c3q*(cont1 + (c3q - c2m1)*(cont2 + (c3q - c1m1)*cont3));
+                } else {
+                    z1.setZero(y0.size());
+                    z2.setZero(y0.size());
+                    z3.setZero(y0.size());
+                }
+                w1 = ti11*z1 + ti12*z2 + ti13*z3;
+                w2 = ti21*z1 + ti22*z2 + ti23*z3;
+                w3 = ti31*z1 + ti32*z2 + ti33*z3;
+
+                // Simplified Newton iteration for the transformed stage increments
+                faccon = std::pow(std::max(faccon, eps), value_t(0.8));
+                theta = value_t(0);
+
+                bool converged = false;
+                bool diverged = false;
+                auto dv_factor = value_t(0.5);
+                auto dyno_old = value_t(1);
+
+                size_t iterations = 0;
+                for(; (iterations < max_iterations) && !converged && !diverged; ++iterations) {
+                    ys = y0 + z1;
+                    internal::evaluate(func, v + c1*dv, ys, a1);
+                    ys = y0 + z2;
+                    internal::evaluate(func, v + c2*dv, ys, a2);
+                    ys = y0 + z3;
+                    internal::evaluate(func, v + dv, ys, a3);
+                    evals += 3;
+
+                    // Transform the function values and form the Newton right hand sides
+                    ys = ti11*a1 + ti12*a2 + ti13*a3 - (u1/dv)*w1;
+                    d2 = ti21*a1 + ti22*a2 + ti23*a3 - (alpha/dv)*w2 + (beta/dv)*w3;
+                    d3 = ti31*a1 + ti32*a2 + ti33*a3 - (beta/dv)*w2 - (alpha/dv)*w3;
+
+                    linear.solve(ys, d1);
+                    linear.solve(d2, d3, d2, d3);
+
+                    const auto n1 = this->tolerance.norm(y0, y0, d1);
+                    const auto n2 = this->tolerance.norm(y0, y0, d2);
+                    const auto n3 = this->tolerance.norm(y0, y0, d3);
+                    const auto dyno = std::sqrt((n1*n1 + n2*n2 + n3*n3) / value_t(3)) / this->tolerance.bound();
+                    if(iterations > 0) {
+                        theta = dyno / dyno_old;
+                        if(theta < value_t(0.99)) {
+                            faccon = theta / (value_t(1) - theta);
+                            const auto remaining = static_cast<value_t>(max_iterations - 1 - iterations);
+                            const auto dyth = faccon * dyno * std::pow(theta, remaining) / fnewt;
+                            if(dyth >= value_t(1)) {
+                                // Convergence is too slow to finish within the iteration limit
+                                const auto qnewt = std::max(value_t(1e-4), std::min(value_t(20), dyth));
+                                dv_factor = value_t(0.8) * std::pow(qnewt, value_t(-1) / (value_t(4) + remaining));
+                                diverged = true;
+                            }
+                        } else {
+                            diverged = true;
+                        }
+                    }
+                    dyno_old = std::max(dyno, eps);
+
+                    if(!diverged) {
+                        w1 += d1;
+                        w2 += d2;
+                        w3 += d3;
+                        z1 = t11*w1 + t12*w2 + t13*w3;
+                        z2 = t21*w1 + t22*w2 + t23*w3;
+                        z3 = t31*w1 + w2;
+                        converged = (faccon * dyno) <= fnewt;
+                    }
+                }
+                newton_iterations += iterations;
+
+                if(!converged && (dv > limiter.min)) {
+                    // Retry with a smaller step and, if it is out of date, a new Jacobian
+                    if(!jacobian_fresh) {
+                        jacobian_evals += linear.jacobian(funcs, v, y0, f0);
+                        jacobians += 1;
+                        jacobian_fresh = true;
+                        factored_dv = value_t(0);
+                    }
+                    dv_next = dv * dv_factor;
+                    rejected = true;
+                    rejections += 1;
+                    continue;
+                }
+
+                // Embedded error estimate, filtered through (u1/dv*I - J)^-1
+                ys = (dd1/dv)*z1 + (dd2/dv)*z2 + (dd3/dv)*z3;
+                d1 = f0 + ys;
+                linear.solve(d1, err);
+                if((this->tolerance.norm(y0, y0, err) > this->tolerance.bound()) && (first || rejected)) {
+                    d1 = y0 + err;
+                    internal::evaluate(func, v, d1, a1);
+                    evals += 1;
+                    d1 = a1 + ys;
+                    linear.solve(d1, err);
+                }
+
+                y1 = y0 + z3;
+                ys = y1 + err;
+                const auto update = this->controller.template updateError<5>(
+                            dv, limiter.min, this->tolerance.norm(y0, y1, ys - y1), this->tolerance.bound()
+                    );
+                // The new step size is reduced further when the Newton iteration was slow
+                const auto safety = value_t(0.9) * value_t(2*max_iterations + 1) / value_t(2*max_iterations + iterations);
+                done = update.done;
+                dv_next = update.dv * std::min(safety, value_t(1));
+                rejected = !done;
+                if(rejected) {
+                    have_history = false;
+                    rejections += 1;
+                }
+            } while(!done);
+
+            // Collocation polynomial of the accepted step, for dense output and prediction
+            first = false;
+            v0_ = v;
+            dv_ = dv;
+            y0_ = y0;
+            cont1 = (z2 - z3) / c2m1;
+            d1 = (z1 - z2) / c1mc2;
+            d2 = z1 / c1;
+            d2 = (d1 - d2) / c2;
+            cont2 = (d1 - cont1) / c1m1;
+            cont3 = cont2 - d2;
+            have_history = true;
+
+            // Reuse the Jacobian while the Newton iteration contracts quickly and the
+            //  factorizations while the step size would only grow slightly
+            jacobian_current = (theta <= theta_reuse);
+            const auto ratio = dv_next / dv;
+            if((ratio >= value_t(1)) && (ratio <= reuse_max)) {
+                dv_next = dv;
+            }
+
+            return return_t{dv, dv_next, y1, evals, rejections, jacobians, decompositions, jacobian_evals, newton_iterations};
+        }
+
+        //
+        // Cubic dense output of the last step from the collocation polynomial.  The polynomial is
+        //  stored relative to the end of the step, s = theta - 1, and is converted to powers of
+        //  theta here.
+        //
+        dense_t dense() const {
+            constexpr auto sq6 = value_t(2.4494897427831780981972840747059);
+            constexpr auto c1m1 = (value_t(4) - sq6) / value_t(10) - value_t(1);
+            constexpr auto c2m1 = (value_t(4) + sq6) / value_t(10) - value_t(1);
+
+            // p(s) = y1 + s*(cont1 + (s - c2m1)*(cont2 + (s - c1m1)*cont3))
+            const state_t p1 = cont1 - c2m1*cont2 + (c2m1*c1m1)*cont3;
+            const state_t p2 = cont2 - (c2m1 + c1m1)*cont3;
+            const state_t& p3 = cont3;
+
+            auto result = dense_t(v0_, dv_, y0_);
+            result.r[0] = p1 - value_t(2)*p2 + value_t(3)*p3;
+            result.r[1] = p2 - value_t(3)*p3;
+            result.r[2] = p3;
+            return result;
+        }
+
+        const linearization_t& linearization() const { return linear; }
+
+    protected:
+        linearization_t linear;
+        bool jacobian_current;
+        value_t factored_dv;
+        bool have_history;
+        bool rejected;
+        bool first;
+        value_t theta;
+        value_t faccon;
+
+        state_t f0;
+        state_t a1, a2, a3;
+        state_t z1, z2, z3;
+        state_t w1, w2, w3;
+        state_t d1, d2, d3;
+        state_t ys;
+        state_t err;
+        state_t y1;
+        state_t cont1, cont2, cont3;
+        value_t v0_;
+        value_t dv_;
+        state_t y0_;
+};
+
+template<typename Value, size_t N>
+using Radau5 = BasicRadau5<Value, N, internal::DenseLinearization>;
+
+} /*namespace method*/
+} /*namespace epode*/
+
+#endif // EPODE_RADAU_H
@@ -2,9 +2,9 @@
 //
 // File - Epode/rk2.h:
 //
-//      Implementation of a selection of Runge-Kutta 2nd-order methods.  Initially, a generic
-//  Runge-Kutta 2nd-order class is implemented and the remainder of the methods -- Heun's,
-//  Ralston's and Explicit Midpoint -- are derived from that.
+//      Implementation of a selection of Runge-Kutta 2nd-order methods.  A generic Runge-Kutta
+//  2nd-order class, with the free parameter set at runtime, is implemented along with tableaus
+//  for the named methods -- Heun's, Ralston's and Explicit Midpoint.
 //
 //
 // License:
@@ -21,6 +21,7 @@
 #include <iostream>
 
 #include "core.h"
+#include "explicit_rk.h"
 
 namespace epode
 {
@@ -33,7 +34,7 @@ class GenericRK2 : public internal::Fixed<Value, 2>
     public:
         using value_t = Value;
         using state_t = internal::State<value_t, N>;
-        using return_t = internal::MethodReturn<value_t, state_t>;
+        using return_t = internal::MethodReturnRef<value_t, state_t>;
 
         explicit constexpr GenericRK2(const value_t& _eta)
             : c0(_eta),
@@ -42,57 +43,81 @@ class GenericRK2 : public internal::Fixed<Value, 2>
         {}
 
 		template<typename Func, typename Limiter>
-        return_t operator () (Func func, value_t dv, value_t v, state_t y, Limiter) {
-            const auto k0 = func(v, y);
-            const auto k1 = func(v+(c0*dv), y+(c0*dv*k0));
-            return return_t{dv, dv, y + (dv * (c1*k0 + c2*k1)), 2};
+        return_t operator () (Func func, value_t dv, value_t v, const state_t& y, Limiter) {
+            internal::evaluate(func, v, y, k0);
+            ys = y+(c0*dv*k0);
+            internal::evaluate(func, v+(c0*dv), ys, k1);
+            y1 = y + (dv * (c1*k0 + c2*k1));
+            return return_t{dv, dv, y1, 2};
         }
 
     private:
         const value_t c0;
         const value_t c2;
         const value_t c1;
+
+        // Stage buffers, reused for every step
+        state_t k0;
+        state_t k1;
+        state_t ys;
+        state_t y1;
 };
 
+} /*namespace method*/
+
+namespace internal
+{
+
 //
-// Implement specific second-order Runge-Kutta methods
+// Implement specific second-order Runge-Kutta methods, with the tableau of the generic method
+//  for a fixed eta: c = (0, eta) and b = (1 - 1/(2 eta), 1/(2 eta))
 //
 
 //  Heun's Method, eta = 1
-template<typename Value, size_t N>
-class Heuns : public GenericRK2<Value, N>
+struct HeunsTableau
 {
-    public:
-		Heuns() : GenericRK2<Value, N>(Value(1)) {}
-		// TODO: THIS WOULD BE BETTER TO SIMPLY DEFAULT LIKE THIS...
-		//Heuns<Value, N>& operator =(const Heuns<Value, N>& _src) = default;
-		// IT ISN'T WORKING THOUGH, AS IT IS STILL TREATING THE FUNCTION AS DELETED
-		// AS SUCH, IT IS NECESSARY TO DEFINE AN EMPTY VERSION IN THIS, MIDPOINT, AND RALSTON
-		// THIS SHOULD BE FIXED....
-		Heuns& operator =(const Heuns&) { return *this; }
+    static constexpr size_t stages = 2;
+    static constexpr size_t order = 2;
+    static constexpr Rational c[stages] = {0, 1};
+    static constexpr Rational a[stages][stages] = {{}, {1}};
+    static constexpr Rational b[stages] = {{1, 2}, {1, 2}};
 };
 
 //  Explicit Midpoint Method, eta = 1/2
-template<typename Value, size_t N>
-class Midpoint : public GenericRK2<Value, N>
+struct MidpointTableau
 {
-    public:
-        Midpoint() : GenericRK2<Value, N>(Value(1)/Value(2)) {}
-		Midpoint& operator =(const Midpoint&) { return* this; }
+    static constexpr size_t stages = 2;
+    static constexpr size_t order = 2;
+    static constexpr Rational c[stages] = {0, {1, 2}};
+    static constexpr Rational a[stages][stages] = {{}, {{1, 2}}};
+    static constexpr Rational b[stages] = {0, 1};
 };
 
 //  Ralston's Method, eta = 2/3
-template<typename Value, size_t N>
-class Ralstons : public GenericRK2<Value, N>
+struct RalstonsTableau
 {
-    public:
-        Ralstons() : GenericRK2<Value, N>(Value(2)/Value(3)) {}
-		Ralstons& operator = (const Ralstons&) { return *this; }
+    static constexpr size_t stages = 2;
+    static constexpr size_t order = 2;
+    static constexpr Rational c[stages] = {0, {2, 3}};
+    static constexpr Rational a[stages][stages] = {{}, {{2, 3}}};
+    static constexpr Rational b[stages] = {{1, 4}, {3, 4}};
 };
 
+} /*namespace internal*/
+
+namespace method
+{
+
+template<typename Value, size_t N>
+using Heuns = ExplicitRK<Value, N, internal::HeunsTableau>;
+
+template<typename Value, size_t N>
+using Midpoint = ExplicitRK<Value, N, internal::MidpointTableau>;
+
+template<typename Value, size_t N>
+using Ralstons = ExplicitRK<Value, N, internal::RalstonsTableau>;
+
 } /*namespace method*/
 } /*namespace epode*/
 
 #endif // EPODE_RK2_H
-
-
@@ -19,257 +19,93 @@
 
 #ifndef EPODE_RKF_H
 #define EPODE_RKF_H
-#include "core.h"
-#include "step.h"
+#include "explicit_rk.h"
 
 namespace epode
 {
-namespace method
+namespace internal
 {
 
-template<typename Value, size_t N>
-class RKF12 : public internal::Adaptive<Value, 1>
+struct RKF12Tableau
 {
-    public:
-        using value_t = Value;
-        using state_t = internal::State<value_t, N>;
-        using return_t = internal::MethodReturn<value_t, state_t>;
-
-        using internal::Adaptive<Value, 1>::Adaptive; // Inherit Construtors
-
-		template<typename Func>
-        void init(value_t /*dv*/, value_t v0, state_t y0, Func func) {
-            k0 = func(v0, y0);
-        }
-
-		template<typename Func, typename Limiter>
-        return_t operator () (Func func, value_t dv, value_t v, state_t y0, Limiter limiter) {
-            constexpr auto c0 = value_t(1) / value_t(2);
-            constexpr auto c1 = value_t(1) / value_t(256);
-            constexpr auto c2 = value_t(255) / value_t(256);
-            constexpr auto c3 = value_t(1) / value_t(512);
-
-			size_t evals = 0;
-
-            auto y1 = y0;
-            auto dv_next = dv;
-            bool done = false;
-			state_t k2{};
-
-            do {
-                dv = limiter.constrain(dv_next);
-                const auto k1 = func(v+(c0*dv), y0+(c0*dv*k0));
-                y1 = y0 + dv*(c1*k0 + c2*k1);
-                k2 = func(v+dv, y1);
-                evals += 2;
-
-                const auto z1 = y0 + dv*(c3*(k0+k2) + c2*k1);
-
-				const auto update = step::internal::updateStepSize<1>(
-                            dv, limiter.min, y1, z1, this->tolerance
-                    );
-				done = update.done;
-                dv_next = update.dv;
-            } while(!done);
-
-            k0 = k2;
-            return return_t{dv, dv_next, y1, evals};
-        }
-
-    protected:
-        state_t k0;
+    static constexpr size_t stages = 3;
+    static constexpr size_t order = 1;
+    static constexpr Rational c[stages] = {0, {1, 2}, 1};
+    static constexpr Rational a[stages][stages] = {
+        {},
+        {{1, 2}},
+        {{1, 256}, {255, 256}}
+    };
+    static constexpr Rational b[stages] = {{1, 256}, {255, 256}, 0};
+    static constexpr Rational e[stages] = {{-1, 512}, 0, {1, 512}};
 };
 
-template<typename Value, size_t N>
-class RKF23 : public internal::Adaptive<Value, 2>
+struct RKF23Tableau
 {
-    public:
-        using value_t = Value;
-        using state_t = internal::State<value_t, N>;
-        using return_t = internal::MethodReturn<value_t, state_t>;
-
-        using internal::Adaptive<Value, 2>::Adaptive; // Inherit Construtors
-
-		template<typename Func>
-        void init(value_t /*dv*/, value_t v0, state_t y0, Func func) {
-            k0 = func(v0, y0);
-        }
-
-		template<typename Func, typename Limiter>
-        return_t operator () (Func func, value_t dv, value_t v, state_t y0, Limiter limiter) {
-            constexpr auto c0 = value_t(1) / value_t(4);
-            constexpr auto c1 = value_t(27) / value_t(40);
-            constexpr auto c2 = value_t(-189) / value_t(800);
-            constexpr auto c3 = value_t(729) / value_t(800);
-            constexpr auto c4 = value_t(214) / value_t(891);
-            constexpr auto c5 = value_t(1) / value_t(33);
-            constexpr auto c6 = value_t(650) / value_t(891);
-            constexpr auto c7 = value_t(533) / value_t(2106);
-            constexpr auto c8 = value_t(800) / value_t(1053);
-            constexpr auto c9 = value_t(-1) / value_t(78);
-
-            size_t evals = 0;
-
-            auto y1 = y0;
-            auto dv_next = dv;
-            bool done = false;
-            state_t k3{};
-
-            do {
-                dv = limiter.constrain(dv_next);
-                const auto k1 = func(v+(c0*dv), y0+(c0*dv*k0));
-                const auto k2 = func(v+(c1*dv), y0+(dv*(c2*k0 + c3*k1)));
-                y1 = y0 + dv*(c4*k0 + c5*k1 + c6*k2);
-                k3 = func(v+dv, y1);
-                evals += 3;
-
-                const auto z1 = y0 + dv*(c7*k0 + c8*k2 + c9*k3);
-                const auto update = step::internal::updateStepSize<2>(
-                            dv, limiter.min, y1, z1, this->tolerance
-                    );
-                done = update.done;
-                dv_next = update.dv;
-            } while(!done);
-            k0 = k3;
-            return return_t{dv, dv_next, y1, evals};
-        }
-
-    protected:
-        state_t k0;
+    static constexpr size_t stages = 4;
+    static constexpr size_t order = 2;
+    static constexpr Rational c[stages] = {0, {1, 4}, {27, 40}, 1};
+    static constexpr Rational a[stages][stages] = {
+        {},
+        {{1, 4}},
+        {{-189, 800}, {729, 800}},
+        {{214, 891}, {1, 33}, {650, 891}}
+    };
+    static constexpr Rational b[stages] = {{214, 891}, {1, 33}, {650, 891}, 0};
+    static constexpr Rational e[stages] = {{23, 1782}, {-1, 33}, {350, 11583}, {-1, 78}};
 };
 
-template<typename Value, size_t N>
-class RKF34 : public internal::Adaptive<Value, 3>
+struct RKF34Tableau
 {
-    public:
-        using value_t = Value;
-        using state_t = internal::State<value_t, N>;
-        using return_t = internal::MethodReturn<value_t, state_t>;
-
-        using internal::Adaptive<Value, 3>::Adaptive; // Inherit Construtors
-
-		template<typename Func>
-        void init(value_t /*dv*/, value_t v0, state_t y0, Func func) {
-            k0 = func(v0, y0);
-        }
-
-		template<typename Func, typename Limiter>
-        return_t operator () (Func func, value_t dv, value_t v, state_t y0, Limiter limiter) {
-            constexpr auto c0 = value_t(1) / value_t(4);
-            constexpr auto c1 = value_t(4) / value_t(9);
-            constexpr auto c2 = value_t(4) / value_t(81);
-            constexpr auto c3 = value_t(32) / value_t(81);
-            constexpr auto c4 = value_t(6) / value_t(7);
-            constexpr auto c5 = value_t(57) / value_t(98);
-            constexpr auto c6 = value_t(-432) / value_t(343);
-            constexpr auto c7 = value_t(1053) / value_t(686);
-            constexpr auto c8 = value_t(1) / value_t(6);
-            constexpr auto c9 = value_t(27) / value_t(52);
-            constexpr auto c10 = value_t(49) / value_t(156);
-            constexpr auto c11 = value_t(43) / value_t(288);
-            constexpr auto c12 = value_t(243) / value_t(416);
-            constexpr auto c13 = value_t(343) / value_t(1872);
-            constexpr auto c14 = value_t(1) / value_t(12);
-
-            size_t evals = 0;
-
-            auto y1 = y0;
-            auto dv_next = dv;
-            bool done = false;
-            state_t k4{};
-
-            do {
-                dv = limiter.constrain(dv_next);
-                const auto k1 = func(v+(c0*dv), y0+(c0*dv*k0));
-                const auto k2 = func(v+(c1*dv), y0+(dv*(c2*k0 + c3*k1)));
-                const auto k3 = func(v+(c4*dv), y0+(dv*(c5*k0 + c6*k1 + c7*k2)));
-                y1 = y0 + dv*(c8*k0 + c9*k2 + c10*k3);
-                k4 = func(v+dv, y1);
-
-                evals += 4;
-                const auto z1 = y0 + dv*(c11*k0 + c12*k2 + c13*k3 + c14*k4);
-                const auto update = step::internal::updateStepSize<3>(
-                            dv, limiter.min, y1, z1, this->tolerance
-                    );
-                done = update.done;
-                dv_next = update.dv;
-            } while(!done);
-            k0 = k4;
-            return return_t{dv, dv_next, y1, evals};
-        }
-
-    protected:
-        state_t k0;
+    static constexpr size_t stages = 5;
+    static constexpr size_t order = 3;
+    static constexpr Rational c[stages] = {0, {1, 4}, {4, 9}, {6, 7}, 1};
+    static constexpr Rational a[stages][stages] = {
+        {},
+        {{1, 4}},
+        {{4, 81}, {32, 81}},
+        {{57, 98}, {-432, 343}, {1053, 686}},
+        {{1, 6}, 0, {27, 52}, {49, 156}}
+    };
+    static constexpr Rational b[stages] = {{1, 6}, 0, {27, 52}, {49, 156}, 0};
+    static constexpr Rational e[stages] = {{-5, 288}, 0, {27, 416}, {-245, 1872}, {1, 12}};
 };
 
-template<typename Value, size_t N>
-class RKF45 : public internal::Adaptive<Value, 4>
+struct RKF45Tableau
 {
-    public:
-        using value_t = Value;
-        using state_t = internal::State<value_t, N>;
-        using return_t = internal::MethodReturn<value_t, state_t>;
-
-        using internal::Adaptive<Value, 4>::Adaptive; // Inherit Construtors
+    static constexpr size_t stages = 6;
+    static constexpr size_t order = 4;
+    static constexpr size_t dense_degree = 4;
+    static constexpr Rational c[stages] = {0, {1, 4}, {3, 8}, {12, 13}, 1, {1, 2}};
+    static constexpr Rational a[stages][stages] = {
+        {},
+        {{1, 4}},
+        {{3, 32}, {9, 32}},
+        {{1932, 2197}, {-7200, 2197}, {7296, 2197}},
+        {{439, 216}, -8, {3680, 513}, {-845, 4104}},
+        {{-8, 27}, 2, {-3544, 2565}, {1859, 4104}, {-11, 40}}
+    };
+    static constexpr Rational b[stages] = {{25, 216}, 0, {1408, 2565}, {2197, 4104}, {-1, 5}, 0};
+    static constexpr Rational e[stages] = {{1, 360}, 0, {-128, 4275}, {-2197, 75240}, {1, 50}, {2, 55}};
+    static constexpr Rational mid[stages + 1] = {{119, 864}, 0, {1016, 2565}, {-2197, 16416}, {11, 160}, 0, {1, 32}};
+};
 
-		template<typename Func, typename Limiter>
-        return_t operator () (Func func, value_t dv, value_t v, state_t y0, Limiter limiter) {
-            constexpr auto c0 = value_t(1) / value_t(4);
-            constexpr auto c1 = value_t(3) / value_t(8);
-            constexpr auto c2 = value_t(3) / value_t(32);
-            constexpr auto c3 = value_t(9) / value_t(32);
-            constexpr auto c4 = value_t(12) / value_t(13);
-            constexpr auto c5 = value_t(1932) / value_t(2197);
-            constexpr auto c6 = value_t(-7200) / value_t(2197);
-            constexpr auto c7 = value_t(7296) / value_t(2197);
-            constexpr auto c8 = value_t(439) / value_t(216);
-            constexpr auto c9 = value_t(-8);
-            constexpr auto c10 = value_t(3680) / value_t(513);
-            constexpr auto c11 = value_t(-845) / value_t(4104);
-            constexpr auto c12 = value_t(1) / value_t(2);
-            constexpr auto c13 = value_t(-8) / value_t(27);
-            constexpr auto c14 = value_t(2);
-            constexpr auto c15 = value_t(-3544) / value_t(2565);
-            constexpr auto c16 = value_t(1859) / value_t(4104);
-            constexpr auto c17 = value_t(-11) / value_t(40);
-            constexpr auto c18 = value_t(25) / value_t(216);
-            constexpr auto c19 = value_t(1408) / value_t(2565);
-            constexpr auto c20 = value_t(2197) / value_t(4104);
-            constexpr auto c21 = value_t(-1) / value_t(5);
-            constexpr auto c22 = value_t(16) / value_t(135);
-            constexpr auto c23 = value_t(6656) / value_t(12825);
-            constexpr auto c24 = value_t(28561) / value_t(56430);
-            constexpr auto c25 = value_t(-9) / value_t(50);
-            constexpr auto c26 = value_t(2) / value_t(55);
+} /*namespace internal*/
 
-            const auto k0 = func(v, y0);
-            size_t evals = 1;
+namespace method
+{
 
-            auto y1 = y0;
-            auto dv_next = dv;
-            bool done = false;
+template<typename Value, size_t N>
+using RKF12 = ExplicitRK<Value, N, internal::RKF12Tableau>;
 
-            do {
-                dv = limiter.constrain(dv_next);
-                const auto k1 = func(v+(c0*dv), y0+(c0*dv*k0));
-                const auto k2 = func(v+(c1*dv), y0+(dv*(c2*k0 + c3*k1)));
-                const auto k3 = func(v+(c4*dv), y0+(dv*(c5*k0 + c6*k1 + c7*k2)));
-                const auto k4 = func(v+dv, y0+(dv*(c8*k0 + c9*k1 + c10*k2 + c11*k3)));
-                const auto k5 = func(v+(c12*dv), y0+(dv*(c13*k0 + c14*k1 + c15*k2 + c16*k3 + c17*k4)));
+template<typename Value, size_t N>
+using RKF23 = ExplicitRK<Value, N, internal::RKF23Tableau>;
 
-                evals += 5;
-                y1 = y0 + dv*(c18*k0 + c19*k2 + c20*k3 + c21*k4);
-                const auto z1 = y0 + dv*(c22*k0 + c23*k2 + c24*k3 + c25*k4 + c26*k5);
-                const auto update = step::internal::updateStepSize<4>(
-                            dv, limiter.min, y1, z1, this->tolerance
-                    );
-                done = update.done;
-                dv_next = update.dv;
-            } while(!done);
+template<typename Value, size_t N>
+using RKF34 = ExplicitRK<Value, N, internal::RKF34Tableau>;
 
-            return return_t{dv, dv_next, y1, evals};
-        }
-};
+template<typename Value, size_t N>
+using RKF45 = ExplicitRK<Value, N, internal::RKF45Tableau>;
 
 } /*namespace method*/
 } /*namespace epode*/
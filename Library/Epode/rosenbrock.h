@@ -0,0 +1,282 @@
+//
+//
+// File - Epode/rosenbrock.h:
+//
+//      Implementation of adaptive Rosenbrock (linearly implicit Runge-Kutta) methods for stiff
+//  systems.  Each stage requires the solution of a linear system with the matrix
+//  (1/(gamma*dv))*I - J, where J is the Jacobian at the start of the step, so no Newton iteration
+//  is needed.  The Jacobian and the derivative with respect to the integration variable are
+//  evaluated once per step and are reused if the step is rejected; the iteration matrix is
+//  factored once per step attempt.  The systems are not declared autonomous, so the derivative
+//  with respect to v is always taken, by one further evaluation of the system which is counted
+//  with the Jacobian evaluations.
+//
+//      The methods are written in the form used by KPP (Sandu et al., "Benchmarking stiff ODE
+//  solvers for atmospheric chemistry problems II: Rosenbrock solvers", 1997), from which the
+//  coefficients are taken:
+//
+//          G = (1/(gamma*dv))*I - J
+//          G*k_i = f(v + alpha_i*dv, y + sum_j a_ij*k_j) + sum_j (c_ij/dv)*k_j + dv*gamma_i*df/dv
+//          y1 = y + sum_i m_i*k_i,  error = sum_i e_i*k_i
+//
+//
+// License:
+//
+//      This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0.
+//  If a copy of the MPL was not distributed with this file, You can obtain one
+//  at http://mozilla.org/MPL/2.0/.
+//
+//
+
+#ifndef EPODE_ROSENBROCK_H
+#define EPODE_ROSENBROCK_H
+
+#include <array>
+#include <cmath>
+#include <limits>
+#include <tuple>
+
+#include "core.h"
+#include "implicit.h"
+#include "step.h"
+
+namespace epode
+{
+namespace internal
+{
+//
+// Rosenbrock method coefficients.  The strictly lower triangular a and c matrices are stored by
+//  rows.  When new_f[i] is false, stage i reuses the function value of stage i-1.
+//
+template<typename Value, size_t Stages>
+struct RosenbrockTableau
+{
+        using value_t = Value;
+        static constexpr size_t stages = Stages;
+
+        static constexpr size_t index(size_t i, size_t j) { return ((i*(i-1))/2) + j; }
+
+        std::array<value_t, (Stages*(Stages-1))/2> a;
+        std::array<value_t, (Stages*(Stages-1))/2> c;
+        std::array<value_t, Stages> alpha;
+        std::array<value_t, Stages> gamma;
+        std::array<value_t, Stages> m;
+        std::array<value_t, Stages> e;
+        std::array<bool, Stages> new_f;
+};
+
+template<typename Value, size_t N, size_t Stages, size_t Order,
+         template<typename V, size_t N2> class Linearization = DenseLinearization>
+class Rosenbrock : public ImplicitAdaptive<Value, Order>
+{
+    public:
+        using value_t = Value;
+        using state_t = State<value_t, N>;
+        using return_t = MethodReturnRef<value_t, state_t>;
+        using tableau_t = RosenbrockTableau<value_t, Stages>;
+        using linearization_t = Linearization<value_t, N>;
+
+        Rosenbrock(const tableau_t& _tableau, const Tolerance<value_t>& _tolerance = defaultTolerance(1e-6, Order),
+                   const step::Controller<value_t>& _controller = step::Controller<value_t>())
+            : ImplicitAdaptive<Value, Order>(_tolerance, _controller), tableau(_tableau) {}
+
+        template<typename Funcs, typename Limiter>
+        return_t operator () (Funcs& funcs, value_t dv, value_t v, const state_t& y0, Limiter limiter) {
+            auto& func = std::get<0>(funcs);
+            const auto& t = tableau;
+
+            // The derivative, Jacobian and derivative with respect to v at the start of the step
+            //  are shared by all of the step attempts
+            evaluate(func, v, y0, f0);
+            size_t evals = 1;
+            size_t decompositions = 0;
+            size_t jacobian_evals = linear.jacobian(funcs, v, y0, f0);
+
+            const auto dv_diff = std::sqrt(std::numeric_limits<value_t>::epsilon()) * std::max(std::abs(v), value_t(1));
+            evaluate(func, v + dv_diff, y0, fs);
+            dfdv = (fs - f0) / dv_diff;
+            jacobian_evals += 1;
+
+            size_t rejected = 0;
+            auto dv_next = dv;
+            bool done = false;
+
+            do {
+                dv = limiter.constrain(dv_next);
+                linear.factor(value_t(1) / (t.gamma[0]*dv));
+                decompositions += 1;
+
+                for(size_t i = 0; i < Stages; ++i) {
+                    if(i == 0) {
+                        rhs = f0;
+                    } else {
+                        if(t.new_f[i]) {
+                            ys = y0;
+                            for(size_t j = 0; j < i; ++j) {
+                                const auto a = t.a[tableau_t::index(i, j)];
+                                if(a != value_t(0)) ys += a*k[j];
+                            }
+                            evaluate(func, v + t.alpha[i]*dv, ys, fs);
+                            evals += 1;
+                        } else if(i == 1) {
+                            fs = f0;
+                        }
+                        rhs = fs;
+                        for(size_t j = 0; j < i; ++j) {
+                            rhs += (t.c[tableau_t::index(i, j)] / dv) * k[j];
+                        }
+                    }
+                    if(t.gamma[i] != value_t(0)) {
+                        rhs += (dv*t.gamma[i]) * dfdv;
+                    }
+                    linear.solve(rhs, k[i]);
+                }
+
+                y1 = y0;
+                z1.setZero(y0.size());
+                for(size_t i = 0; i < Stages; ++i) {
+                    if(t.m[i] != value_t(0)) y1 += t.m[i]*k[i];
+                    if(t.e[i] != value_t(0)) z1 += t.e[i]*k[i];
+                }
+                z1 += y1;
+
+                // The embedded solution is of order Order - 1, so the local error of the estimate is
+                //  O(dv^Order) and the step is scaled by the power 1/Order (controller order Order + 1)
+                const auto update = this->controller.template updateError<Order + 1>(
+                            dv, limiter.min, this->tolerance.norm(y0, y1, z1 - y1), this->tolerance.bound()
+                    );
+                done = update.done;
+                dv_next = update.dv;
+                if(!done) rejected += 1;
+            } while(!done);
+
+            return return_t{dv, dv_next, y1, evals, rejected, 1, decompositions, jacobian_evals};
+        }
+
+        const linearization_t& linearization() const { return linear; }
+
+    protected:
+        tableau_t tableau;
+        linearization_t linear;
+        std::array<state_t, Stages> k;
+        state_t f0;
+        state_t fs;
+        state_t dfdv;
+        state_t ys;
+        state_t rhs;
+        state_t y1;
+        state_t z1;
+};
+} /*namespace internal*/
+
+namespace method
+{
+// TODO: INCLUDE "BENCHMARKING STIFF ODE SOLVERS FOR ATMOSPHERIC CHEMISTRY PROBLEMS II" IN THE DOCUMENTATION
+//
+// Three stage, L-stable Rosenbrock 3(2) method
+//
+template<typename Value, size_t N>
+class Ros3 : public internal::Rosenbrock<Value, N, 3, 3>
+{
+    public:
+        using value_t = Value;
+        using tableau_t = internal::RosenbrockTableau<value_t, 3>;
+
+        Ros3(const Tolerance<value_t>& _tolerance = internal::defaultTolerance(1e-6, 3),
+             const step::Controller<value_t>& _controller = step::Controller<value_t>())
+            : internal::Rosenbrock<Value, N, 3, 3>(coefficients(), _tolerance, _controller) {}
+
+        static tableau_t coefficients() {
+            tableau_t t;
+            t.a = {{ value_t(1), value_t(1), value_t(0) }};
+            t.c = {{
+                value_t(-1.0156171083877702091975600115545),
+                value_t(4.0759956452537699824805835358067),
+                value_t(9.2076794298330791242156818474003)
+            }};
+            t.alpha = {{ value_t(0), value_t(0.43586652150845899941601945119356), value_t(0.43586652150845899941601945119356) }};
+            t.gamma = {{
+                value_t(0.43586652150845899941601945119356),
+                value_t(0.24291996454816804366592249683314),
+                value_t(2.1851380027664058511513169485832)
+            }};
+            t.m = {{ value_t(1), value_t(6.1697947043828245592553615689730), value_t(-0.42772256543218573326238373806514) }};
+            t.e = {{ value_t(0.5), value_t(-2.9079558716805469821718236208017), value_t(0.22354069897811569627360909276199) }};
+            t.new_f = {{ true, true, false }};
+            return t;
+        }
+};
+
+//
+// Four stage, stiffly accurate, L-stable Rosenbrock 3(2) method
+//
+template<typename Value, size_t N>
+class Rodas3 : public internal::Rosenbrock<Value, N, 4, 3>
+{
+    public:
+        using value_t = Value;
+        using tableau_t = internal::RosenbrockTableau<value_t, 4>;
+
+        Rodas3(const Tolerance<value_t>& _tolerance = internal::defaultTolerance(1e-6, 3),
+               const step::Controller<value_t>& _controller = step::Controller<value_t>())
+            : internal::Rosenbrock<Value, N, 4, 3>(coefficients(), _tolerance, _controller) {}
+
+        static tableau_t coefficients() {
+            tableau_t t;
+            t.a = {{ value_t(0), value_t(2), value_t(0), value_t(2), value_t(0), value_t(1) }};
+            t.c = {{ value_t(4), value_t(1), value_t(-1), value_t(1), value_t(-1), value_t(-8)/value_t(3) }};
+            t.alpha = {{ value_t(0), value_t(0), value_t(1), value_t(1) }};
+            t.gamma = {{ value_t(0.5), value_t(1.5), value_t(0), value_t(0) }};
+            t.m = {{ value_t(2), value_t(0), value_t(1), value_t(1) }};
+            t.e = {{ value_t(0), value_t(0), value_t(0), value_t(1) }};
+            t.new_f = {{ true, false, true, true }};
+            return t;
+        }
+};
+
+//
+// Six stage, stiffly accurate, L-stable Rosenbrock 4(3) method
+//
+template<typename Value, size_t N>
+class Rodas4 : public internal::Rosenbrock<Value, N, 6, 4>
+{
+    public:
+        using value_t = Value;
+        using tableau_t = internal::RosenbrockTableau<value_t, 6>;
+
+        Rodas4(const Tolerance<value_t>& _tolerance = internal::defaultTolerance(1e-6, 4),
+               const step::Controller<value_t>& _controller = step::Controller<value_t>())
+            : internal::Rosenbrock<Value, N, 6, 4>(coefficients(), _tolerance, _controller) {}
+
+        static tableau_t coefficients() {
+            tableau_t t;
+            t.a = {{
+                value_t(1.544),
+                value_t(0.9466785280815826), value_t(0.2557011698983284),
+                value_t(3.314825187068521), value_t(2.896124015972201), value_t(0.9986419139977817),
+                value_t(1.221224509226641), value_t(6.019134481288629), value_t(12.53708332932087), value_t(-0.6878860361058950),
+                value_t(1.221224509226641), value_t(6.019134481288629), value_t(12.53708332932087), value_t(-0.6878860361058950), value_t(1)
+            }};
+            t.c = {{
+                value_t(-5.6688),
+                value_t(-2.430093356833875), value_t(-0.2063599157091915),
+                value_t(-0.1073529058151375), value_t(-9.594562251023355), value_t(-20.47028614809616),
+                value_t(7.496443313967647), value_t(-10.24680431464352), value_t(-33.99990352819905), value_t(11.70890893206160),
+                value_t(8.083246795921522), value_t(-7.981132988064893), value_t(-31.52159432874371), value_t(16.31930543123136), value_t(-6.058818238834054)
+            }};
+            t.alpha = {{ value_t(0), value_t(0.386), value_t(0.21), value_t(0.63), value_t(1), value_t(1) }};
+            t.gamma = {{ value_t(0.25), value_t(-0.1043), value_t(0.1035), value_t(-0.03620000000000023), value_t(0), value_t(0) }};
+            t.m = {{
+                value_t(1.221224509226641), value_t(6.019134481288629), value_t(12.53708332932087),
+                value_t(-0.6878860361058950), value_t(1), value_t(1)
+            }};
+            t.e = {{ value_t(0), value_t(0), value_t(0), value_t(0), value_t(0), value_t(1) }};
+            t.new_f = {{ true, true, true, true, true, true }};
+            return t;
+        }
+};
+
+} /*namespace method*/
+} /*namespace epode*/
+
+#endif // EPODE_ROSENBROCK_H
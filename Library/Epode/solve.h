@@ -22,6 +22,7 @@
 #include "bogacki_shampine.h"
 #include "core.h"
 #include "integrator.h"
+#include "output.h"
 
 namespace epode
 {
@@ -51,10 +52,13 @@ template<
 	template<typename V, size_t N> class Method,
 	typename System, typename DValue, typename Value,
 	typename Ender, typename State, 
-	typename Tolerance = typename decltype(internal::stateProperties(State()))::value_t>
-	auto solve(System system, DValue dv, Value v0, Ender end, State y0, const Tolerance & tol = Tolerance{1e-6})
+	typename Tolerance = typename decltype(internal::stateProperties(State()))::value_t,
+	typename Output = output::Every,
+	typename = decltype(internal::stateProperties(std::declval<State>()))>
+	auto solve(System system, DValue dv, Value v0, Ender end, State y0, const Tolerance & tol = Tolerance{1e-6},
+		const Output& output = Output{})
 {
-    using system_properties_t = decltype(internal::stateProperties(system(v0, y0)));
+    using system_properties_t = decltype(internal::stateProperties(internal::systemResult(system, v0, y0, 0)));
     using state_properties_t = decltype(internal::stateProperties(y0));
 
     static_assert(
@@ -70,7 +74,23 @@ template<
     using Solver = Integrator<value_t, system_properties_t::N, Method>;
 		auto solver = internal::SolverConstructImpl<Solver, Solver::method_t::adaptive>::construct(dv, tol);
 
-    return solver(system, v0, end, y0);
+    return solver(system, v0, end, y0, output);
+}
+
+//
+// Solve with an automatically chosen initial step size
+//
+template<
+	template<typename V, size_t N> class Method,
+	typename System, typename Value,
+	typename Ender, typename State,
+	typename Tolerance = typename decltype(internal::stateProperties(State()))::value_t,
+	typename Output = output::Every,
+	typename = decltype(internal::stateProperties(std::declval<State>()))>
+	auto solve(System system, Value v0, Ender end, State y0, const Tolerance & tol = Tolerance{1e-6},
+		const Output& output = Output{})
+{
+    return solve<Method>(system, Value(0), v0, end, y0, tol, output);
 }
 
 namespace internal
@@ -83,10 +103,24 @@ using SolveDefaultMethod = method::BS45<V, N>;
 
 template<typename System, typename DValue, typename Value, 
 	typename Ender, typename State, 
-	typename Tolerance = typename decltype(internal::stateProperties(State()))::value_t>
-auto solve(System system, DValue dv, Value v0, Ender end, State y0, const Tolerance& tol = Tolerance(1e-6))
+	typename Tolerance = typename decltype(internal::stateProperties(State()))::value_t,
+	typename Output = output::Every,
+	typename = decltype(internal::stateProperties(std::declval<State>()))>
+auto solve(System system, DValue dv, Value v0, Ender end, State y0, const Tolerance& tol = Tolerance(1e-6),
+	const Output& output = Output{})
+{
+    return solve<internal::SolveDefaultMethod>(system, dv, v0, end, y0, tol, output);
+}
+
+template<typename System, typename Value,
+	typename Ender, typename State,
+	typename Tolerance = typename decltype(internal::stateProperties(State()))::value_t,
+	typename Output = output::Every,
+	typename = decltype(internal::stateProperties(std::declval<State>()))>
+auto solve(System system, Value v0, Ender end, State y0, const Tolerance& tol = Tolerance(1e-6),
+	const Output& output = Output{})
 {
-    return solve<internal::SolveDefaultMethod>(system, dv, v0, end, y0, tol);
+    return solve<internal::SolveDefaultMethod>(system, Value(0), v0, end, y0, tol, output);
 }
 
 } /*namespace epode*/
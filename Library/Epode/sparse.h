@@ -0,0 +1,292 @@
+//
+//
+// File - Epode/sparse.h:
+//
+//      Sparse Jacobian storage and sparse factorization for the implicit methods.  For large
+//  systems (reaction networks, discretized PDEs) the dense N x N Jacobian does not fit in cache,
+//  or in memory, while the number of non-zeros is only a small multiple of N.  The sparse
+//  linearization keeps the Jacobian as an Eigen::SparseMatrix and factors the iteration matrix
+//  with a sparse direct solver.  The application functions are passed as:
+//
+//          epode::fns(f, jac)            - jac(v, y, J) fills (or jac(v, y) returns) the sparse J
+//          epode::fns(f, jac, pattern)   - J is given the structure of pattern before jac is called,
+//                                          so that jac only has to set values (J.coeffRef(i, j))
+//          epode::fns(f, pattern)        - J is approximated by forward differences over the
+//                                          non-zeros of pattern, with grouped columns
+//
+//  where pattern is any Eigen sparse matrix with the structure of the Jacobian (its values are
+//  ignored).
+//
+//      The symbolic analysis (fill reducing ordering and elimination structure) of the iteration
+//  matrix is done once and is reused for every numeric factorization as long as the structure
+//  of the Jacobian does not change.  The iteration matrix, scale*I - J, shares one structure (the
+//  Jacobian structure plus the diagonal) for all values of scale, so a change of step size only
+//  needs a numeric refactorization.
+//
+//
+// License:
+//
+//      This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0.
+//  If a copy of the MPL was not distributed with this file, You can obtain one
+//  at http://mozilla.org/MPL/2.0/.
+//
+//
+
+#ifndef EPODE_SPARSE_H
+#define EPODE_SPARSE_H
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <limits>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+#include <Eigen/Sparse>
+
+#include "core.h"
+#include "implicit.h"
+#include "bdf.h"
+#include "radau.h"
+
+namespace epode
+{
+namespace internal
+{
+template<typename Value>
+using SparseJacobian = Eigen::SparseMatrix<Value, Eigen::ColMajor>;
+
+//
+// Sparse solvers usable by the sparse linearization.  The LDLT solver is only valid when the
+//  Jacobian is symmetric (e.g. pure diffusion); the complex systems of Radau IIA are always
+//  factored with the LU solver.
+//
+template<typename Matrix>
+using SparseLUSolver = Eigen::SparseLU<Matrix, Eigen::COLAMDOrdering<typename Matrix::StorageIndex>>;
+
+template<typename Matrix>
+using SparseLDLTSolver = Eigen::SimplicialLDLT<Matrix>;
+
+template<typename Value, size_t N, template<typename M> class Solver>
+class BasicSparseLinearization
+{
+    public:
+        using value_t = Value;
+        using complex_t = std::complex<value_t>;
+        using state_t = State<value_t, N>;
+        using jacobian_t = SparseJacobian<value_t>;
+        using complex_jacobian_t = SparseJacobian<complex_t>;
+        using index_t = typename jacobian_t::StorageIndex;
+
+        BasicSparseLinearization() : analyzed(false), analyzed_complex(false) {}
+
+        // The solvers are not copyable; copies start without a factorization
+        BasicSparseLinearization(const BasicSparseLinearization& _other)
+            : J(_other.J), analyzed(false), analyzed_complex(false) {
+            if(J.size() > 0) updateStructure();
+        }
+
+        BasicSparseLinearization& operator = (const BasicSparseLinearization& _other) {
+            J = _other.J;
+            analyzed = analyzed_complex = false;
+            if(J.size() > 0) updateStructure();
+            return *this;
+        }
+
+        //
+        // Update the Jacobian at (v, y), where f0 = f(v, y).  The number of system function
+        //  evaluations used (zero with a Jacobian function) is returned.
+        //
+        template<typename Funcs>
+        size_t jacobian(Funcs& funcs, value_t v, const state_t& y, const state_t& f0) {
+            static_assert(hasJacobian<Funcs>::value || JacobianPattern<Funcs>::available,
+                          "The sparse linearization requires a Jacobian function or a sparsity pattern.");
+            if(J.size() == 0) initialize(funcs, y.size(), std::integral_constant<bool, JacobianPattern<Funcs>::available>{});
+            const auto evals = jacobianImpl(funcs, v, y, f0, hasJacobian<Funcs>{});
+            if(!sameStructure()) updateStructure();
+            return evals;
+        }
+
+        // Factor the iteration matrix, scale*I - J
+        void factor(value_t scale) {
+            assemble(m, value_t(scale));
+            if(!analyzed) {
+                lu.analyzePattern(m);
+                analyzed = true;
+            }
+            lu.factorize(m);
+            if(lu.info() != Eigen::Success) {
+                throw std::runtime_error("epode: sparse factorization of the iteration matrix failed");
+            }
+        }
+
+        // Solve (scale*I - J) x = rhs, for row vector states.  The solver only writes column
+        //  vectors, which a transposed single element state is not.
+        template<typename Rhs, typename X>
+        void solve(const Rhs& rhs, X& x) {
+            b = rhs.transpose();
+            xb = lu.solve(b);
+            x = xb.transpose();
+        }
+
+        // Factor the complex iteration matrix, (alpha + i*beta)*I - J
+        void factor(value_t alpha, value_t beta) {
+            assemble(mc, complex_t(alpha, beta));
+            if(!analyzed_complex) {
+                luc.analyzePattern(mc);
+                analyzed_complex = true;
+            }
+            luc.factorize(mc);
+            if(luc.info() != Eigen::Success) {
+                throw std::runtime_error("epode: sparse factorization of the iteration matrix failed");
+            }
+        }
+
+        // Solve ((alpha + i*beta)*I - J) (x_re + i*x_im) = rhs_re + i*rhs_im
+        template<typename Re, typename Im, typename XRe, typename XIm>
+        void solve(const Re& rhs_re, const Im& rhs_im, XRe& x_re, XIm& x_im) {
+            bc.resize(rhs_re.size());
+            bc.real() = rhs_re.transpose();
+            bc.imag() = rhs_im.transpose();
+            xc = luc.solve(bc);
+            x_re = xc.real().transpose();
+            x_im = xc.imag().transpose();
+        }
+
+        const jacobian_t& matrix() const { return J; }
+
+    protected:
+        // Give the Jacobian the structure of the pattern, with zero values
+        template<typename Funcs>
+        void initialize(Funcs& funcs, Eigen::Index, std::true_type) {
+            J = JacobianPattern<Funcs>::get(funcs).template cast<value_t>();
+            J.coeffs().setZero();
+            updateStructure();
+        }
+
+        template<typename Funcs>
+        void initialize(Funcs&, Eigen::Index n, std::false_type) {
+            J.resize(n, n);
+        }
+
+        template<typename Funcs>
+        size_t jacobianImpl(Funcs& funcs, value_t v, const state_t& y, const state_t&, std::true_type) {
+            return evaluateJacobian(std::get<1>(funcs), v, y, J);
+        }
+
+        // Forward differences over the non-zeros of the pattern, with grouped columns
+        template<typename Funcs>
+        size_t jacobianImpl(Funcs& funcs, value_t v, const state_t& y, const state_t& f0, std::false_type) {
+            if(coloring.columns.empty()) coloring = colorColumns(JacobianPattern<Funcs>::get(funcs));
+            return coloredDifferences(std::get<0>(funcs), v, y, f0, coloring, yp, fp,
+                [this](Eigen::Index col, Eigen::Index idx, Eigen::Index, value_t dfdy) {
+                    J.valuePtr()[J.outerIndexPtr()[col] + idx] = dfdy;
+                }
+            );
+        }
+
+        // Check that the Jacobian still has the structure which was analyzed
+        bool sameStructure() {
+            J.makeCompressed();
+            const auto cols = static_cast<size_t>(J.outerSize());
+            const auto nnz = static_cast<size_t>(J.nonZeros());
+            return (outer.size() == cols + 1) && (inner.size() == nnz) &&
+                std::equal(outer.begin(), outer.end(), J.outerIndexPtr()) &&
+                std::equal(inner.begin(), inner.end(), J.innerIndexPtr());
+        }
+
+        //
+        // Build the structure of the iteration matrices (the Jacobian structure plus the
+        //  diagonal) and the positions of the Jacobian entries and of the diagonal in it.  The
+        //  symbolic analysis is redone on the next factorization.
+        //
+        void updateStructure() {
+            J.makeCompressed();
+            const auto n = J.outerSize();
+
+            jacobian_t identity(J.rows(), J.cols());
+            identity.setIdentity();
+            identity.coeffs().setZero();
+            m = jacobian_t(J + identity);
+            m.makeCompressed();
+            mc = m.template cast<complex_t>();
+
+            outer.assign(J.outerIndexPtr(), J.outerIndexPtr() + n + 1);
+            inner.assign(J.innerIndexPtr(), J.innerIndexPtr() + J.nonZeros());
+            positions.resize(inner.size());
+            diagonal.resize(static_cast<size_t>(n));
+            for(Eigen::Index col = 0; col < n; ++col) {
+                auto k = m.outerIndexPtr()[col];
+                for(auto idx = outer[col]; idx < outer[col+1]; ++idx) {
+                    while(m.innerIndexPtr()[k] != inner[idx]) ++k;
+                    positions[idx] = k;
+                }
+                k = m.outerIndexPtr()[col];
+                while(m.innerIndexPtr()[k] != col) ++k;
+                diagonal[col] = k;
+            }
+
+            analyzed = false;
+            analyzed_complex = false;
+        }
+
+        // Set the values of an iteration matrix to shift*I - J
+        template<typename Matrix, typename Shift>
+        void assemble(Matrix& matrix, Shift shift) const {
+            matrix.coeffs().setZero();
+            auto values = matrix.valuePtr();
+            for(size_t idx = 0; idx < positions.size(); ++idx) {
+                values[positions[idx]] = -J.valuePtr()[idx];
+            }
+            for(const auto k : diagonal) {
+                values[k] += shift;
+            }
+        }
+
+        jacobian_t J;
+        jacobian_t m;
+        complex_jacobian_t mc;
+        Solver<jacobian_t> lu;
+        SparseLUSolver<complex_jacobian_t> luc;
+        bool analyzed;
+        bool analyzed_complex;
+
+        std::vector<index_t> outer;      // Analyzed Jacobian structure
+        std::vector<index_t> inner;
+        std::vector<index_t> positions;  // Position of each Jacobian entry in the iteration matrix
+        std::vector<index_t> diagonal;   // Position of the diagonal in the iteration matrix
+
+        ColumnColoring coloring;
+        Eigen::Matrix<value_t, stateColumns(N), 1> b;
+        Eigen::Matrix<value_t, stateColumns(N), 1> xb;
+        Eigen::Matrix<complex_t, stateColumns(N), 1> bc;
+        Eigen::Matrix<complex_t, stateColumns(N), 1> xc;
+        state_t yp;
+        state_t fp;
+};
+
+template<typename Value, size_t N>
+using SparseLinearization = BasicSparseLinearization<Value, N, SparseLUSolver>;
+
+template<typename Value, size_t N>
+using SymmetricSparseLinearization = BasicSparseLinearization<Value, N, SparseLDLTSolver>;
+
+} /*namespace internal*/
+
+namespace method
+{
+//
+// The implicit methods with sparse Jacobians, for large systems
+//
+template<typename Value, size_t N>
+using SparseRadau5 = BasicRadau5<Value, N, internal::SparseLinearization>;
+
+template<typename Value, size_t N>
+using SparseBDF = BasicBDF<Value, N, internal::SparseLinearization>;
+
+} /*namespace method*/
+} /*namespace epode*/
+
+#endif // EPODE_SPARSE_H
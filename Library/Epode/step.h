@@ -17,18 +17,26 @@
 #define STEP
 #include <cmath>
 #include <initializer_list>
+#include <limits>
+#include <type_traits>
+#include <utility>
 
 namespace epode
 {
 namespace step
 {
 
+//
+// Bounds on the step size.  The default minimum is a few machine epsilons, so it only stops the
+//  step from vanishing; an absolute minimum such as 1e-3 would limit the accuracy of every
+//  adaptive method and end integrations up to a minimum step short of their end value.
+//
 template<typename Value>
 struct StepLimits
 {
         using value_t = Value;
 
-        StepLimits(const value_t& _max = value_t(1e6), const value_t& _min = value_t(1e-3))
+        StepLimits(const value_t& _max = value_t(1e6), const value_t& _min = value_t(16) * std::numeric_limits<value_t>::epsilon())
             : max(_max), min(_min) {}
 
         constexpr value_t constrain(const value_t& dv) const {
@@ -102,6 +110,150 @@ StepSizeUpdate<Value> updateStepSize(
     }();
 }
 
+//  The exponent, 1/k, of the step size scaling for an adaptive method of order N, as above
+template<typename Value, size_t N>
+constexpr Value scalingExponent() {
+    return Value(1) / Value((N > 1) ? (N - 1) : 1);
+}
+
+} /*namespace internal*/
+
+//
+// Step size controller of the adaptive methods, in the general form of Soderlind ("Digital
+//  filters in adaptive time-stepping", 2003),
+//
+//      dv_next = dv * safety * r_n^(beta1/k) * r_n-1^(beta2/k) * r_n-2^(beta3/k)
+//
+//  where r = tolerance / error for the current and the last two accepted steps.  A step is
+//  accepted when its error is within the tolerance; a rejected step is retried with the
+//  elementary (I) factor alone and does not enter the history.  A step whose error is not a
+//  number is rejected with the smallest scaling.  The scaling is limited to [scale_min,
+//  scale_max].  The default is the elementary controller of updateStepSize() with a safety factor
+//  of 0.9, so that the proposed step is not at the limit of the tolerance.
+//
+// TODO: INCLUDE "DIGITAL FILTERS IN ADAPTIVE TIME-STEPPING" (SODERLIND) IN THE DOCUMENTATION
+template<typename Value>
+class Controller
+{
+    public:
+        using value_t = Value;
+
+        explicit Controller(value_t _beta1 = value_t(1), value_t _beta2 = value_t(0), value_t _beta3 = value_t(0),
+                   value_t _safety = value_t(0.9),
+                   value_t _scale_min = value_t(0.33), value_t _scale_max = value_t(3.0))
+            : beta1(_beta1), beta2(_beta2), beta3(_beta3), safety(_safety),
+              scale_min(_scale_min), scale_max(_scale_max), r1(1), r2(1) {}
+
+        //
+        // Accept or reject a step with the error estimate |z - y| and propose the next step size.
+        //  The history of an accepted step is kept for the next proposal.
+        //
+        template<size_t N, typename StateY, typename StateZ>
+        internal::StepSizeUpdate<value_t> update(
+                    const value_t& dv, const value_t& dv_min,
+                    const StateY& y, const StateZ& z, const value_t& tolerance) {
+            return updateError<N>(dv, dv_min, (z-y).norm(), tolerance);
+        }
+
+        template<size_t N>
+        internal::StepSizeUpdate<value_t> updateError(
+                    const value_t& dv, const value_t& dv_min,
+                    const value_t& error, const value_t& tolerance) {
+            const auto result = checkError<N>(dv, dv_min, error, tolerance);
+            if(result.done) {
+                r2 = r1;
+                r1 = (error == value_t(0)) ? value_t(1) : ratio(error, tolerance);
+            }
+            return result;
+        }
+
+        // As update(), without changing the history -- for preliminary error estimates
+        template<size_t N, typename StateY, typename StateZ>
+        internal::StepSizeUpdate<value_t> check(
+                    const value_t& dv, const value_t& dv_min,
+                    const StateY& y, const StateZ& z, const value_t& tolerance) const {
+            return checkError<N>(dv, dv_min, (z-y).norm(), tolerance);
+        }
+
+        template<size_t N>
+        internal::StepSizeUpdate<value_t> checkError(
+                    const value_t& dv, const value_t& dv_min,
+                    const value_t& error, const value_t& tolerance) const {
+            using std::pow;
+            constexpr auto exponent = internal::scalingExponent<value_t, N>();
+
+            if(error == value_t(0)) return {true, dv * scale_max};
+
+            // An error which is not a number rejects the step and shrinks it as far as allowed
+            const auto r = ratio(error, tolerance);
+            if(!(r >= value_t(1))) {
+                if(dv <= dv_min) return {true, dv_min};
+                const auto scale = safety * pow(r, exponent);
+                return {false, dv * (!(scale >= scale_min) ? scale_min : scale)};
+            }
+
+            auto scale = safety * pow(r, beta1*exponent);
+            if(beta2 != value_t(0)) scale *= pow(r1, beta2*exponent);
+            if(beta3 != value_t(0)) scale *= pow(r2, beta3*exponent);
+            return {true, dv * ((scale > scale_max) ? scale_max : ((scale < scale_min) ? scale_min : scale))};
+        }
+
+        // Forget the step history, as when the integration is restarted
+        void reset() {
+            r1 = value_t(1);
+            r2 = value_t(1);
+        }
+
+    protected:
+        static value_t ratio(const value_t& error, const value_t& tolerance) {
+            using std::abs;
+            return abs(tolerance / error);
+        }
+
+        value_t beta1;
+        value_t beta2;
+        value_t beta3;
+        value_t safety;
+        value_t scale_min;
+        value_t scale_max;
+        value_t r1; // tolerance / error of the last accepted step
+        value_t r2; // ... and of the one before it
+};
+
+//  Elementary (integral) controller
+template<typename Value>
+class IController : public Controller<Value>
+{
+    public:
+        IController(Value _safety = Value(0.9), Value _scale_min = Value(0.33), Value _scale_max = Value(3.0))
+            : Controller<Value>(Value(1), Value(0), Value(0), _safety, _scale_min, _scale_max) {}
+};
+
+//  Proportional-integral controller of Gustafsson, with the coefficients of Hairer and Wanner
+// TODO: INCLUDE "CONTROL THEORETIC TECHNIQUES FOR STEPSIZE SELECTION IN EXPLICIT RUNGE-KUTTA METHODS" (GUSTAFSSON) IN THE DOCUMENTATION
+template<typename Value>
+class PIController : public Controller<Value>
+{
+    public:
+        PIController(Value _beta1 = Value(0.7), Value _beta2 = Value(-0.4), Value _safety = Value(0.9),
+                     Value _scale_min = Value(0.2), Value _scale_max = Value(5.0))
+            : Controller<Value>(_beta1, _beta2, Value(0), _safety, _scale_min, _scale_max) {}
+};
+
+//  Proportional-integral-derivative controller, with the coefficients of Kennedy and Carpenter
+// TODO: INCLUDE "ADDITIVE RUNGE-KUTTA SCHEMES FOR CONVECTION-DIFFUSION-REACTION EQUATIONS" (KENNEDY AND CARPENTER) IN THE DOCUMENTATION
+template<typename Value>
+class PIDController : public Controller<Value>
+{
+    public:
+        PIDController(Value _beta1 = Value(0.49), Value _beta2 = Value(-0.34), Value _beta3 = Value(0.1),
+                      Value _safety = Value(0.9), Value _scale_min = Value(0.2), Value _scale_max = Value(5.0))
+            : Controller<Value>(_beta1, _beta2, _beta3, _safety, _scale_min, _scale_max) {}
+};
+
+namespace internal
+{
+
 //
 // Construct a step limiter object based on the input "end" specification
 //
@@ -122,15 +274,36 @@ auto constructLimiter(std::initializer_list<Value> vs) {
     return [=](auto, auto v) { return LimitsType(v1-v); };
 }
 
+//  Detect a trigger with a bound on the integration variable (see triggers.h)
+template<typename Trigger, typename Value, typename = void>
+struct hasBound : std::false_type {};
+
+template<typename Trigger, typename Value>
+struct hasBound<Trigger, Value, decltype(std::declval<const Trigger&>().template bound<Value>(), void())>
+    : std::true_type {};
+
 //  Construct default limiter, if type is unknown, construct a default limiter
 template<typename LimitsType,
          typename Value,
          typename Initializer,
-         typename = std::enable_if_t<!std::is_convertible<Initializer, Value>::value> >
+         typename = std::enable_if_t<!std::is_convertible<Initializer, Value>::value &&
+                                     !hasBound<Initializer, Value>::value> >
 auto constructLimiter(Initializer) {
     return [=](auto, auto) { return LimitsType(); };
 }
 
+//  Limiter for a trigger which ends the integration at a bound on the integration variable
+template<typename LimitsType,
+         typename Value,
+         typename Trigger,
+         typename = std::enable_if_t<hasBound<Trigger, Value>::value>,
+         typename = void>
+auto constructLimiter(const Trigger& trigger) {
+    const auto v1 = trigger.template bound<Value>();
+    const auto bounded = (v1 != std::numeric_limits<Value>::infinity());
+    return [=](auto, auto v) { return bounded ? LimitsType(v1-v) : LimitsType(); };
+}
+
 } /*namespace internal*/
 } /*namespace step*/
 } /*namespace epode*/
@@ -0,0 +1,260 @@
+//
+//
+// File - Epode/stepper.h:
+//
+//      Implementation of the resumable Stepper class.  A stepper owns the complete state of a
+//  single integration (integration variable, step size, system state, statistics, step limits
+//  and the method object) and advances that state in place.  The Integrator class uses a stepper
+//  internally, but it may also be used directly when integration needs to be interleaved with
+//  other work or continued from the last state.
+//
+//
+// License:
+//
+//      This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0.
+//  If a copy of the MPL was not distributed with this file, You can obtain one
+//  at http://mozilla.org/MPL/2.0/.
+//
+//
+
+#ifndef EPODE_STEPPER_H
+#define EPODE_STEPPER_H
+
+#include <cmath>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "core.h"
+#include "dense.h"
+#include "implicit.h"
+#include "instrument.h"
+#include "step.h"
+
+namespace epode
+{
+namespace internal
+{
+//
+// These overloads determine if the integration method object has an init member function
+//  and, if so, it calls it.
+//
+template<typename V, typename S, typename... Ts>
+void initMethod(V, V, const S&, Ts&&...) {}
+
+template<typename V, typename S, typename Func, typename M>
+auto initMethod(V dv, V v, const S& y, Func _func, M& _method)
+-> decltype(_method.init(dv, v, y, _func)) {
+    return _method.init(dv, v, y, _func);
+}
+
+//
+// The order of the first step of a method.  Variable order methods report their current order
+//  with an order() member function and always start at first order.
+//
+template<typename M, typename = void>
+struct startingOrder : std::integral_constant<size_t, 1> {};
+
+template<typename M>
+struct startingOrder<M, decltype(std::integral_constant<size_t, M::order>(), void())>
+    : std::integral_constant<size_t, M::order> {};
+
+//
+// The error tolerance used to choose the initial step size.  Fixed step methods have none, so
+//  they use the default tolerance of an adaptive method of the same order.
+//
+template<typename Value, typename M, typename = std::enable_if_t<M::adaptive> >
+Tolerance<Value> methodTolerance(const M& _method) { return _method.stepTolerance(); }
+
+template<typename Value, typename M, typename = std::enable_if_t<!M::adaptive>, typename = void>
+Tolerance<Value> methodTolerance(const M&) {
+    return Tolerance<Value>(defaultTolerance(Value(1e-6), startingOrder<M>::value));
+}
+
+//
+// Estimate the initial step size of a method of the given order, as in Hairer, Norsett and
+//  Wanner (section II.4).  A first guess from the sizes of the state and its derivative is
+//  refined by an explicit Euler step to estimate the second derivative.  Two function
+//  evaluations are required.
+//
+// TODO: INCLUDE "SOLVING ORDINARY DIFFERENTIAL EQUATIONS I" (HAIRER, NORSETT, WANNER) IN THE DOCUMENTATION
+template<size_t Order, typename Func, typename Value, typename State, typename Tol>
+Value initialStepSize(Func& func, const Value& v0, const State& y0, const Tol& tolerance,
+                      const Value& dv_max) {
+    using std::max;
+    using std::min;
+    using std::pow;
+    const auto scaled = [&](const auto& x) { return tolerance.norm(y0, y0, x) / tolerance.bound(); };
+
+    State f0 = y0;
+    evaluate(func, v0, y0, f0);
+    const auto d0 = scaled(y0);
+    const auto d1 = scaled(f0);
+    auto dv0 = ((d0 < Value(1e-5)) || (d1 < Value(1e-5))) ? Value(1e-6) : Value(0.01) * d0 / d1;
+    dv0 = min(dv0, dv_max);
+
+    const State y1 = y0 + dv0 * f0;
+    State f1 = y0;
+    evaluate(func, v0 + dv0, y1, f1);
+    const auto d2 = scaled(f1 - f0) / dv0;
+
+    const auto d = max(d1, d2);
+    const auto dv1 = (d <= Value(1e-15)) ?
+                max(Value(1e-6), dv0 * Value(1e-3)) :
+                pow(Value(0.01) / d, Value(1) / Value(Order + 1));
+    return min(min(Value(100) * dv0, dv1), dv_max);
+}
+} /*namespace internal*/
+
+template<typename Value, size_t N, template<typename V, size_t N2> class Method, typename Funcs,
+         typename Instrumentation = instrument::Counters>
+class Stepper
+{
+    public:
+        using value_t = Value;
+        using method_t = Method<value_t, N>;
+        using state_t = internal::State<value_t, N>;
+        using limits_t = step::StepLimits<value_t>;
+        using funcs_t = Funcs;
+        using instrumenter_t = internal::Instrumenter<Instrumentation, funcs_t>;
+        using stats_t = typename instrumenter_t::stats_t;
+
+        Stepper(const funcs_t& _funcs, const method_t& _method, value_t _dv0)
+            : funcs(_funcs), method_(_method), instrumenter(_funcs), dv_(_dv0), v_(), y_(), stats_(), limits_() {}
+
+        //
+        // Set the initial integration state and call the init hook of the method, if it has
+        //  one.  This is the only place that the method is initialized; calls to step() and
+        //  step_until() always continue from the current state.  When the initial step size is
+        //  zero it is estimated from the system (see internal::initialStepSize()).
+        //
+        void init(value_t v0, const state_t& y0) {
+            v_ = v0;
+            y_ = y0;
+            stats_ = stats_t{};
+            limits_ = limits_t{};
+            if(dv_ == value_t(0)) {
+                dv_ = internal::initialStepSize<internal::startingOrder<method_t>::value>(
+                    std::get<0>(funcs), v_, y_, internal::methodTolerance<value_t>(method_), limits_.max
+                );
+                stats_.update(0, 2);
+            }
+            internal::initMethod(dv_, v_, y_, internal::methodFunctions<method_t>(funcs), method_);
+        }
+
+        //
+        // Take a single step using the current step limits.  The state is updated in place and
+        //  the size of the step actually taken is returned.  Fixed step methods keep their
+        //  nominal step size; only the step taken is limited (to land on an end or sample point).
+        //
+        //  A step to a state or step size which is not finite fails: the state is left at the
+        //  start of the step, zero is returned and the status becomes Status::Diverged.
+        //
+        value_t step() {
+            using std::isfinite;
+            const auto dv = limits_.constrain(dv_);
+
+            auto result = instrumenter.step(funcs, stats_, [&](auto& fs) {
+                return method_(internal::methodFunctions<method_t>(fs), dv, v_, y_, limits_);
+            });
+            const auto dv_next = method_t::adaptive ? result.dv_next : dv_;
+            const auto finite = isfinite(result.dv) && isfinite(dv_next) && result.y.allFinite();
+            stats_.update(finite ? 1 : 0, result.evals, result.rejected, result.jacobians, result.decompositions,
+                          result.jacobian_evals);
+            if(!finite) {
+                stats_.status = Status::Diverged;
+                return value_t(0);
+            }
+
+            v_ += result.dv;
+            dv_ = dv_next;
+            y_ = std::move(result.y); // Copies into the existing storage when the method returns a reference
+            return result.dv;
+        }
+
+        //
+        // Take a single step and then update the step limits with the limiter
+        //
+        template<typename Limiter>
+        value_t step(Limiter limiter) {
+            const auto dv_taken = step();
+            limits_ = limiter(dv_, v_);
+            return dv_taken;
+        }
+
+        //
+        // Update the step limits with the limiter for the current state
+        //
+        template<typename Limiter>
+        void limit(Limiter limiter) {
+            limits_ = limiter(dv_, v_);
+        }
+
+        //
+        // Step until the end trigger fires.  After each step the observer is called with the
+        //  step taken, the new integration variable value, the new state and the statistics.
+        //  Repeated calls continue the integration from where the previous call ended.
+        //
+        template<typename Ender, typename Limiter, typename Observer>
+        void step_until(Ender end, Limiter limiter, Observer observer) {
+            limit(limiter);
+            while(!failed() && !end(dv_, v_, y_, stats_, limits_)) {
+                const auto dv_taken = step(limiter);
+                observer(dv_taken, v_, y_, stats_);
+            }
+        }
+
+        template<typename Ender, typename Limiter>
+        void step_until(Ender end, Limiter limiter) {
+            step_until(end, limiter, [](auto, auto, const auto&, const auto&){});
+        }
+
+        //
+        // Move the end of the last step back to v, within the step, with the state y there.  This
+        //  is used when an event ends the integration part way through a step; if stepping
+        //  continues, the method restarts from the moved state.
+        //
+        void truncate(value_t v, const state_t& y) {
+            v_ = v;
+            y_ = y;
+        }
+
+        // Record why the integration ended
+        void finish(Status status) { stats_.status = status; }
+
+        // Has a step failed (see step())?  The integration cannot continue.
+        bool failed() const { return stats_.status == Status::Diverged; }
+
+        //
+        // Current state accessors
+        //
+        value_t v() const { return v_; }
+        value_t dv() const { return dv_; }
+        const state_t& y() const { return y_; }
+        const stats_t& stats() const { return stats_; }
+        const limits_t& limits() const { return limits_; }
+        const method_t& method() const { return method_; }
+
+        //
+        // Dense output of the last step, for methods which provide it.  Interpolants which
+        //  evaluate the system (DOP853) add their evaluations to the statistics.
+        //
+        auto dense() {
+            stats_.update(0, internal::denseEvaluations<method_t>::value);
+            return internal::denseOutput(method_, internal::methodFunctions<method_t>(funcs));
+        }
+
+    protected:
+        funcs_t funcs;
+        method_t method_;
+        instrumenter_t instrumenter;
+        value_t dv_; // The next step size to attempt (zero to estimate it on init())
+        value_t v_;
+        state_t y_;
+        stats_t stats_;
+        limits_t limits_;
+};
+
+} /*namespace epode*/
+
+#endif // EPODE_STEPPER_H
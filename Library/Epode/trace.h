@@ -0,0 +1,314 @@
+//
+//
+// File - Epode/trace.h:
+//
+//      A timeline of the steps taken by integrations, for finding where (and on which thread) the
+//  step size collapsed.  While a trace::Session is open, every step of every integration records
+//  the integration variable, the step taken and the step proposed for next, the evaluations and
+//  rejected attempts it cost and the wall time it took into a fixed-size ring buffer.  Slots are
+//  claimed without a lock, so the workers of an ensemble() record concurrently; each thread is
+//  given its own track.
+//
+//      The timeline is exported as Chrome trace JSON (chrome://tracing or ui.perfetto.dev), in
+//  which every step is a slice on the track of its thread and the step size of each track is
+//  drawn as a counter, or as a compact binary trace.
+//
+//          epode::trace::Timeline timeline;
+//          {
+//              epode::trace::Session session(timeline);
+//              auto results = epode::ensemble(system, params, dv, v0, v1, y0);
+//          }
+//          epode::trace::toChromeJSON("steps.json", timeline);
+//
+//
+// License:
+//
+//      This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0.
+//  If a copy of the MPL was not distributed with this file, You can obtain one
+//  at http://mozilla.org/MPL/2.0/.
+//
+//
+
+#ifndef EPODE_TRACE_H
+#define EPODE_TRACE_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <limits>
+#include <memory>
+#include <ostream>
+#include <string>
+
+namespace epode
+{
+namespace trace
+{
+
+// A single accepted step and the rejected attempts which preceded it
+struct Step
+{
+        double v;           // The integration variable at the start of the step
+        double dv;          // The step taken
+        double dv_next;     // The step proposed by the method for the next step
+        uint32_t evals;     // Evaluations of the step, including those of rejected attempts
+        uint32_t rejected;  // Rejected attempts before the step was accepted
+        uint32_t track;     // The thread which took the step
+        uint64_t start;     // Nanoseconds from the creation of the timeline
+        uint64_t duration;  // Nanoseconds
+};
+
+namespace internal
+{
+// Small track numbers for threads, in the order in which they first take a step
+inline uint32_t track() {
+    static std::atomic<uint32_t> tracks{0};
+    thread_local const uint32_t idx = tracks.fetch_add(1, std::memory_order_relaxed);
+    return idx;
+}
+} /*namespace internal*/
+
+//
+// The ring buffer of steps.  Writers claim slots with a single atomic increment and, once the
+//  buffer is full, overwrite the oldest steps.  After wraparound two writers may hold the same
+//  slot (a writer which was preempted is lapped by one a capacity of steps later), so each slot
+//  has a sequence lock: the sequence is odd while a step is written into the slot and otherwise
+//  records the step held, and a writer whose step is older than the one held drops its step.
+//  The buffer should only be read (exported) when no integration is recording into it; steps
+//  which are still being written are skipped.
+//
+class Timeline
+{
+    public:
+        using clock_t = std::chrono::steady_clock;
+
+        // The capacity is rounded up to a power of two
+        explicit Timeline(size_t _capacity = size_t(1) << 20)
+            : capacity_(roundUp(_capacity)), slots(new Slot[capacity_]), next(0), epoch(clock_t::now()) {}
+
+        Timeline(const Timeline&) = delete;
+        Timeline& operator= (const Timeline&) = delete;
+
+        void record(double v, double dv, double dv_next, size_t evals, size_t rejected,
+                    clock_t::time_point start, clock_t::time_point end) {
+            const auto idx = next.fetch_add(1, std::memory_order_relaxed);
+            auto& slot = slots[idx & (capacity_ - 1)];
+            const auto held = sequence(idx);
+            auto current = slot.sequence.load(std::memory_order_relaxed);
+            for(;;) {
+                if(current & 1) {
+                    current = slot.sequence.load(std::memory_order_relaxed); // Being written
+                } else if(current > held) {
+                    return; // Lapped by a newer step
+                } else if(slot.sequence.compare_exchange_weak(current, held - 1, std::memory_order_acquire,
+                                                              std::memory_order_relaxed)) {
+                    break;
+                }
+            }
+
+            auto& step = slot.step;
+            step.v = v;
+            step.dv = dv;
+            step.dv_next = dv_next;
+            step.evals = static_cast<uint32_t>(evals);
+            step.rejected = static_cast<uint32_t>(rejected);
+            step.track = internal::track();
+            step.start = nanoseconds(start - epoch);
+            step.duration = nanoseconds(end - start);
+            slot.sequence.store(held, std::memory_order_release);
+        }
+
+        // The number of steps held, at most the capacity
+        size_t size() const { return static_cast<size_t>(std::min<uint64_t>(next.load(), capacity_)); }
+        size_t capacity() const { return capacity_; }
+
+        // The number of steps which were overwritten
+        size_t dropped() const { return static_cast<size_t>(next.load() - size()); }
+
+        void clear() {
+            for(size_t i = 0; i < capacity_; ++i) slots[i].sequence.store(0, std::memory_order_relaxed);
+            next.store(0);
+        }
+
+        // The held steps, oldest first.  Slots which do not (yet) hold their step are skipped.
+        template<typename F>
+        void forEach(F f) const {
+            const auto end = next.load();
+            for(auto idx = end - size(); idx != end; ++idx) {
+                const auto& slot = slots[idx & (capacity_ - 1)];
+                if(slot.sequence.load(std::memory_order_acquire) == sequence(idx)) f(slot.step);
+            }
+        }
+
+        //
+        // Write the steps as Chrome trace events: a complete event ("X") per step and a counter
+        //  ("C") of the step size per track.  Steps which followed rejected attempts are named
+        //  separately so that they stand out.  Times are in microseconds.  Non-finite values (a
+        //  step size which became NaN, say) are written as null.
+        //
+        void writeChromeJSON(std::ostream& out) const {
+            const auto flags = out.flags();
+            const auto precision = out.precision();
+            out.precision(std::numeric_limits<double>::max_digits10);
+
+            out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+            bool first = true;
+            forEach([&](const Step& step) {
+                const auto ts = static_cast<double>(step.start) / 1e3;
+                out << (first ? "\n" : ",\n");
+                out << "{\"name\":\"" << ((step.rejected > 0) ? "step (rejected attempts)" : "step")
+                    << "\",\"cat\":\"epode\",\"ph\":\"X\",\"pid\":1,\"tid\":" << step.track
+                    << ",\"ts\":" << ts << ",\"dur\":" << static_cast<double>(step.duration) / 1e3
+                    << ",\"args\":{\"v\":" << JSONNumber{step.v} << ",\"dv\":" << JSONNumber{step.dv}
+                    << ",\"dv_next\":" << JSONNumber{step.dv_next}
+                    << ",\"evals\":" << step.evals << ",\"rejected\":" << step.rejected << "}},\n";
+                out << "{\"name\":\"dv (track " << step.track << ")\",\"ph\":\"C\",\"pid\":1,\"ts\":" << ts
+                    << ",\"args\":{\"dv\":" << JSONNumber{step.dv} << "}}";
+                first = false;
+            });
+            out << "\n]}\n";
+
+            out.flags(flags);
+            out.precision(precision);
+        }
+
+        //
+        // Write the steps in a compact binary form: the magic "EPODETRC", a uint32 version and a
+        //  uint64 count, followed by the steps as their fields in declaration order, in the byte
+        //  order of the host.
+        //
+        void writeBinary(std::ostream& out) const {
+            const uint32_t version = 1;
+            uint64_t count = 0;
+            forEach([&](const Step&) { count += 1; });
+            out.write("EPODETRC", 8);
+            write(out, version);
+            write(out, count);
+            forEach([&](const Step& step) {
+                write(out, step.v);
+                write(out, step.dv);
+                write(out, step.dv_next);
+                write(out, step.evals);
+                write(out, step.rejected);
+                write(out, step.track);
+                write(out, step.start);
+                write(out, step.duration);
+            });
+        }
+
+    protected:
+        // A step and its sequence: 0 while empty, odd while written and 2*(idx + 1) once it holds
+        //  the step idx
+        struct Slot
+        {
+                std::atomic<uint64_t> sequence{0};
+                Step step;
+        };
+
+        static constexpr uint64_t sequence(uint64_t idx) { return 2*(idx + 1); }
+
+        // A number written to JSON, which has no literal for the non-finite values (null instead)
+        struct JSONNumber
+        {
+                double value;
+
+                friend std::ostream& operator<< (std::ostream& out, const JSONNumber& number) {
+                    if(std::isfinite(number.value)) return out << number.value;
+                    return out << "null";
+                }
+        };
+
+        static size_t roundUp(size_t n) {
+            size_t capacity = 1;
+            while(capacity < n) capacity <<= 1;
+            return capacity;
+        }
+
+        static uint64_t nanoseconds(clock_t::duration d) {
+            return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(d).count());
+        }
+
+        template<typename T>
+        static void write(std::ostream& out, const T& value) {
+            out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+        }
+
+        size_t capacity_;
+        std::unique_ptr<Slot[]> slots;
+        std::atomic<uint64_t> next; // The total number of steps recorded
+        clock_t::time_point epoch;
+};
+
+namespace internal
+{
+// The timeline of the open session, if any
+inline std::atomic<Timeline*>& active() {
+    static std::atomic<Timeline*> timeline{nullptr};
+    return timeline;
+}
+
+//
+// Take a step of the stepper, recording it in the timeline of the open session.  Without a
+//  session, the only cost is the load of the timeline pointer.
+//
+template<typename Stepper, typename Take>
+auto step(const Stepper& s, Take take) {
+    auto timeline = active().load(std::memory_order_acquire);
+    if(timeline == nullptr) return take();
+
+    const auto v = s.v();
+    const auto evals = s.stats().evals;
+    const auto rejected = s.stats().rejected;
+    const auto start = Timeline::clock_t::now();
+    const auto dv = take();
+    timeline->record(
+        static_cast<double>(v), static_cast<double>(dv), static_cast<double>(s.dv()),
+        s.stats().evals - evals, s.stats().rejected - rejected, start, Timeline::clock_t::now()
+    );
+    return dv;
+}
+} /*namespace internal*/
+
+//
+// Record the steps of all integrations, on any thread, into the timeline while the session is
+//  open.  Sessions nest; closing one restores the timeline of the enclosing session.
+//
+class Session
+{
+    public:
+        explicit Session(Timeline& timeline)
+            : previous(internal::active().exchange(&timeline, std::memory_order_acq_rel)) {}
+
+        ~Session() { internal::active().store(previous, std::memory_order_release); }
+
+        Session(const Session&) = delete;
+        Session& operator= (const Session&) = delete;
+
+    protected:
+        Timeline* previous;
+};
+
+//
+// Export functions
+//
+inline bool toChromeJSON(const std::string& filename, const Timeline& timeline) {
+    auto file = std::ofstream{filename, std::ofstream::out};
+    if(!file) return false;
+    timeline.writeChromeJSON(file);
+    return static_cast<bool>(file);
+}
+
+inline bool toBinary(const std::string& filename, const Timeline& timeline) {
+    auto file = std::ofstream{filename, std::ofstream::out | std::ofstream::binary};
+    if(!file) return false;
+    timeline.writeBinary(file);
+    return static_cast<bool>(file);
+}
+
+} /*namespace trace*/
+} /*namespace epode*/
+
+#endif // EPODE_TRACE_H
@@ -6,7 +6,17 @@
 //  are value, statistics and time triggers in addition to the placeholder types, conditional
 //  operators and boolean operators to combine them.
 //
-//  TODO: THIS NEEDS TO BE IMPLEMENTED FROM THE TEST CODE NOT IN THE EPODE REPO
+//      Triggers are expression templates built from the placeholders, so a combined trigger is a
+//  single inline predicate of the step, trigger(dv, v, y, stats, limits), without any indirection:
+//
+//          using namespace epode::triggers::placeholders;
+//          auto end = (_v > 2.0) || (_y[0] <= 0.05) || (_steps > 1e6);
+//
+//  A trigger may be used as an end trigger, as a store trigger (see output::when()) and as a
+//  limit trigger -- when a trigger ends the integration at a bound on the integration variable,
+//  as (_v > 2.0) does above, the steps are limited so that the integration lands on the bound.
+//  As with a scalar end value, the bound is reached when the integration variable is within the
+//  minimum step of it.
 //
 //
 // License:
@@ -19,28 +29,418 @@
 #ifndef EPODE_TRIGGERS_H
 #define EPODE_TRIGGERS_H
 
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <functional>
 #include <initializer_list>
+#include <limits>
 #include <type_traits>
 
+#include "core.h"
+
 namespace epode
 {
 namespace triggers
 {
 namespace internal
 {
-    // TODO: THE MAIN TRIGGER TYPES SHOULD GO HERE
+//
+// Base of all trigger expressions.  The bound is the value of the integration variable at which
+//  the expression is certain to be true, if there is one.  The status is the exit status of an
+//  integration which the expression ended.
+//
+struct Expression
+{
+        template<typename Value>
+        static constexpr Value bound() { return std::numeric_limits<Value>::infinity(); }
+
+        template<typename D, typename Value, typename Y, typename S, typename L>
+        static constexpr Status status(const D&, const Value&, const Y&, const S&, const L&) { return Status::Completed; }
+};
+
+template<typename T>
+struct isExpression : std::is_base_of<Expression, std::decay_t<T>> {};
+
+// Expressions combine with other expressions and with numeric constants
+template<typename T>
+struct isOperand : std::integral_constant<bool, isExpression<T>::value || std::is_arithmetic<std::decay_t<T>>::value> {};
+
+template<typename L, typename R>
+using enableOperands = std::enable_if_t<
+        isOperand<L>::value && isOperand<R>::value && (isExpression<L>::value || isExpression<R>::value)
+    >;
+
+//
+// Terminals
+//
+
+// Integration variable
+struct V : Expression
+{
+        template<typename D, typename Value, typename Y, typename S, typename L>
+        constexpr Value operator() (const D&, const Value& v, const Y&, const S&, const L&) const { return v; }
+};
+
+// Step size
+struct DV : Expression
+{
+        template<typename D, typename Value, typename Y, typename S, typename L>
+        constexpr D operator() (const D& dv, const Value&, const Y&, const S&, const L&) const { return dv; }
+};
+
+// A single component of the state
+struct Component : Expression
+{
+        constexpr explicit Component(size_t _idx) : idx(_idx) {}
+
+        template<typename D, typename Value, typename Y, typename S, typename L>
+        constexpr auto operator() (const D&, const Value&, const Y& y, const S&, const L&) const { return y[idx]; }
+
+        size_t idx;
+};
+
+// The state -- only its components may be used in expressions
+struct State
+{
+        constexpr Component operator[] (size_t idx) const { return Component(idx); }
+};
+
+// Integrator statistics
+struct Steps : Expression
+{
+        template<typename D, typename Value, typename Y, typename S, typename L>
+        constexpr auto operator() (const D&, const Value&, const Y&, const S& stats, const L&) const { return stats.steps; }
+};
+
+struct Evals : Expression
+{
+        template<typename D, typename Value, typename Y, typename S, typename L>
+        constexpr auto operator() (const D&, const Value&, const Y&, const S& stats, const L&) const { return stats.evals; }
+};
+
+struct Rejected : Expression
+{
+        template<typename D, typename Value, typename Y, typename S, typename L>
+        constexpr auto operator() (const D&, const Value&, const Y&, const S& stats, const L&) const { return stats.rejected; }
+};
+
+template<typename T>
+struct Constant : Expression
+{
+        constexpr explicit Constant(const T& _value) : value(_value) {}
+
+        template<typename D, typename Value, typename Y, typename S, typename L>
+        constexpr T operator() (const D&, const Value&, const Y&, const S&, const L&) const { return value; }
+
+        T value;
+};
+
+//
+// Operations
+//
+
+// Arithmetic and comparison of two expressions
+template<typename Op, typename Left, typename Right>
+struct Binary : Expression
+{
+        constexpr Binary(const Left& _left, const Right& _right) : left(_left), right(_right) {}
+
+        template<typename D, typename Value, typename Y, typename S, typename L>
+        constexpr auto operator() (const D& dv, const Value& v, const Y& y, const S& stats, const L& limits) const {
+            return Op{}(left(dv, v, y, stats, limits), right(dv, v, y, stats, limits));
+        }
+
+        Left left;
+        Right right;
+};
+
+template<typename Left, typename Right>
+struct And : Expression
+{
+        constexpr And(const Left& _left, const Right& _right) : left(_left), right(_right) {}
+
+        template<typename D, typename Value, typename Y, typename S, typename L>
+        constexpr bool operator() (const D& dv, const Value& v, const Y& y, const S& stats, const L& limits) const {
+            return left(dv, v, y, stats, limits) && right(dv, v, y, stats, limits);
+        }
+
+        Left left;
+        Right right;
+};
+
+//  The side which fired is recorded, so the status does not evaluate the (possibly stateful)
+//  operands again.
+template<typename Left, typename Right>
+struct Or : Expression
+{
+        constexpr Or(const Left& _left, const Right& _right) : left(_left), right(_right), left_fired(false) {}
+
+        template<typename D, typename Value, typename Y, typename S, typename L>
+        bool operator() (const D& dv, const Value& v, const Y& y, const S& stats, const L& limits) const {
+            left_fired = left(dv, v, y, stats, limits);
+            return left_fired || right(dv, v, y, stats, limits);
+        }
+
+        // Either side ends the integration at its bound
+        template<typename Value>
+        constexpr Value bound() const {
+            return std::min(left.template bound<Value>(), right.template bound<Value>());
+        }
+
+        template<typename D, typename Value, typename Y, typename S, typename L>
+        Status status(const D& dv, const Value& v, const Y& y, const S& stats, const L& limits) const {
+            return left_fired ?
+                        left.status(dv, v, y, stats, limits) :
+                        right.status(dv, v, y, stats, limits);
+        }
+
+        Left left;
+        Right right;
+        mutable bool left_fired; // Did the left side fire in the last evaluation?
+};
+
+template<typename Operand>
+struct Not : Expression
+{
+        constexpr explicit Not(const Operand& _operand) : operand(_operand) {}
+
+        template<typename D, typename Value, typename Y, typename S, typename L>
+        constexpr bool operator() (const D& dv, const Value& v, const Y& y, const S& stats, const L& limits) const {
+            return !operand(dv, v, y, stats, limits);
+        }
+
+        Operand operand;
+};
+
+// The integration variable has reached a bound, within the minimum step (_v > bound)
+template<typename T>
+struct Past : Expression
+{
+        constexpr explicit Past(const T& _value) : value(_value) {}
+
+        template<typename D, typename Value, typename Y, typename S, typename L>
+        constexpr bool operator() (const D&, const Value& v, const Y&, const S&, const L& limits) const {
+            return v >= (Value(value) - limits.min);
+        }
+
+        template<typename Value>
+        constexpr Value bound() const { return Value(value); }
+
+        T value;
+};
+
+//
+// Budgets which end a runaway integration
+//
+
+// The number of system evaluations reaches a limit
+struct MaxEvals : Expression
+{
+        constexpr explicit MaxEvals(size_t _limit) : limit(_limit) {}
+
+        template<typename D, typename Value, typename Y, typename S, typename L>
+        constexpr bool operator() (const D&, const Value&, const Y&, const S& stats, const L&) const {
+            return stats.evals >= limit;
+        }
+
+        template<typename D, typename Value, typename Y, typename S, typename L>
+        static constexpr Status status(const D&, const Value&, const Y&, const S&, const L&) { return Status::EvalLimit; }
+
+        size_t limit;
+};
+
+// The number of rejected steps reaches a limit
+struct MaxRejected : Expression
+{
+        constexpr explicit MaxRejected(size_t _limit) : limit(_limit) {}
+
+        template<typename D, typename Value, typename Y, typename S, typename L>
+        constexpr bool operator() (const D&, const Value&, const Y&, const S& stats, const L&) const {
+            return stats.rejected >= limit;
+        }
+
+        template<typename D, typename Value, typename Y, typename S, typename L>
+        static constexpr Status status(const D&, const Value&, const Y&, const S&, const L&) { return Status::RejectLimit; }
+
+        size_t limit;
+};
+
+// The next step size falls below a floor (or is not a number)
+template<typename T>
+struct MinStep : Expression
+{
+        constexpr explicit MinStep(const T& _floor) : floor(_floor) {}
+
+        template<typename D, typename Value, typename Y, typename S, typename L>
+        constexpr bool operator() (const D& dv, const Value&, const Y&, const S&, const L&) const {
+            return !(dv >= D(floor));
+        }
+
+        template<typename D, typename Value, typename Y, typename S, typename L>
+        static constexpr Status status(const D&, const Value&, const Y&, const S&, const L&) { return Status::StepLimit; }
+
+        T floor;
+};
+
+//
+// The wall-clock time since the first check exceeds a limit.  The clock is only read every
+//  stride steps; once the time has expired the trigger stays expired.
+//
+template<typename Duration, typename Clock = std::chrono::steady_clock>
+struct MaxTime : Expression
+{
+        MaxTime(const Duration& _limit, size_t _stride)
+            : limit(_limit), stride((_stride == 0) ? 1 : _stride), started(false), expired(false) {}
+
+        template<typename D, typename Value, typename Y, typename S, typename L>
+        bool operator() (const D&, const Value&, const Y&, const S& stats, const L&) const {
+            if(!started) {
+                start = Clock::now();
+                started = true;
+            } else if(!expired && ((stats.steps % stride) == 0)) {
+                expired = (Clock::now() - start) > limit;
+            }
+            return expired;
+        }
+
+        template<typename D, typename Value, typename Y, typename S, typename L>
+        static constexpr Status status(const D&, const Value&, const Y&, const S&, const L&) { return Status::TimeLimit; }
+
+        Duration limit;
+        size_t stride;
+        mutable typename Clock::time_point start;
+        mutable bool started;
+        mutable bool expired;
+};
+
+//
+// Operators -- found by argument dependent lookup for the expression types
+//
+template<typename T>
+constexpr T wrap(const T& operand, std::true_type) { return operand; }
+
+template<typename T>
+constexpr Constant<T> wrap(const T& operand, std::false_type) { return Constant<T>(operand); }
+
+template<typename T>
+constexpr auto wrap(const T& operand) { return wrap(operand, isExpression<T>{}); }
+
+template<typename Op, typename L, typename R>
+constexpr auto binary(const L& l, const R& r) {
+    return Binary<Op, decltype(wrap(l)), decltype(wrap(r))>(wrap(l), wrap(r));
+}
+
+template<typename L, typename R, typename = enableOperands<L, R> >
+constexpr auto operator+ (const L& l, const R& r) { return binary<std::plus<>>(l, r); }
+
+template<typename L, typename R, typename = enableOperands<L, R> >
+constexpr auto operator- (const L& l, const R& r) { return binary<std::minus<>>(l, r); }
+
+template<typename L, typename R, typename = enableOperands<L, R> >
+constexpr auto operator* (const L& l, const R& r) { return binary<std::multiplies<>>(l, r); }
+
+template<typename L, typename R, typename = enableOperands<L, R> >
+constexpr auto operator/ (const L& l, const R& r) { return binary<std::divides<>>(l, r); }
+
+template<typename L, typename R, typename = enableOperands<L, R> >
+constexpr auto operator< (const L& l, const R& r) { return binary<std::less<>>(l, r); }
+
+template<typename L, typename R, typename = enableOperands<L, R> >
+constexpr auto operator<= (const L& l, const R& r) { return binary<std::less_equal<>>(l, r); }
+
+template<typename L, typename R, typename = enableOperands<L, R> >
+constexpr auto operator> (const L& l, const R& r) { return binary<std::greater<>>(l, r); }
+
+template<typename L, typename R, typename = enableOperands<L, R> >
+constexpr auto operator>= (const L& l, const R& r) { return binary<std::greater_equal<>>(l, r); }
+
+template<typename L, typename R, typename = enableOperands<L, R> >
+constexpr auto operator== (const L& l, const R& r) { return binary<std::equal_to<>>(l, r); }
+
+template<typename L, typename R, typename = enableOperands<L, R> >
+constexpr auto operator!= (const L& l, const R& r) { return binary<std::not_equal_to<>>(l, r); }
+
+template<typename L, typename R, typename = enableOperands<L, R> >
+constexpr auto operator&& (const L& l, const R& r) {
+    return And<decltype(wrap(l)), decltype(wrap(r))>(wrap(l), wrap(r));
+}
+
+template<typename L, typename R, typename = enableOperands<L, R> >
+constexpr auto operator|| (const L& l, const R& r) {
+    return Or<decltype(wrap(l)), decltype(wrap(r))>(wrap(l), wrap(r));
+}
+
+template<typename E, typename = std::enable_if_t<isExpression<E>::value> >
+constexpr Not<E> operator! (const E& e) { return Not<E>(e); }
+
+// Bounds on the integration variable from below end the integration
+template<typename T, typename = std::enable_if_t<std::is_arithmetic<T>::value> >
+constexpr Past<T> operator> (const V&, const T& value) { return Past<T>(value); }
+
+template<typename T, typename = std::enable_if_t<std::is_arithmetic<T>::value> >
+constexpr Past<T> operator>= (const V&, const T& value) { return Past<T>(value); }
+
+template<typename T, typename = std::enable_if_t<std::is_arithmetic<T>::value> >
+constexpr Past<T> operator< (const T& value, const V&) { return Past<T>(value); }
+
+template<typename T, typename = std::enable_if_t<std::is_arithmetic<T>::value> >
+constexpr Past<T> operator<= (const T& value, const V&) { return Past<T>(value); }
+
 } /*namespace internal*/
 
-// TODO: THE MAIN TRIGGER FUNCTIONS SHOULD GO HERE... OR EVEN IN THE BASE EPODE NAMESPACE...?
+//
+// Trigger placeholders
+//
+namespace placeholders
+{
+constexpr internal::V _v{};
+constexpr internal::DV _dv{};
+constexpr internal::State _y{};
+constexpr internal::Steps _steps{};
+constexpr internal::Evals _evals{};
+constexpr internal::Rejected _rejected{};
+} /*namespace placeholders*/
+
+//
+// Budget triggers.  These combine with the other triggers, for example
+//  (_v > 10.0) || maxEvals(100000) || maxTime(std::chrono::milliseconds(5)), and set the exit
+//  status of an integration which they end.
+//
+template<typename Rep, typename Period>
+internal::MaxTime<std::chrono::duration<Rep, Period>> maxTime(
+        const std::chrono::duration<Rep, Period>& limit, size_t stride = 16) {
+    return internal::MaxTime<std::chrono::duration<Rep, Period>>(limit, stride);
+}
+
+constexpr internal::MaxEvals maxEvals(size_t limit) { return internal::MaxEvals(limit); }
+
+constexpr internal::MaxRejected maxRejected(size_t limit) { return internal::MaxRejected(limit); }
+
+template<typename T>
+constexpr internal::MinStep<T> minStep(const T& floor) { return internal::MinStep<T>(floor); }
 
 namespace internal
 {
 
+// The exit status of an integration ended by a trigger
+template<typename Trigger, typename D, typename Value, typename Y, typename S, typename L,
+         typename = std::enable_if_t<isExpression<Trigger>::value> >
+Status exitStatus(const Trigger& trigger, const D& dv, const Value& v, const Y& y, const S& stats, const L& limits) {
+    return trigger.status(dv, v, y, stats, limits);
+}
+
+template<typename Trigger, typename D, typename Value, typename Y, typename S, typename L,
+         typename = std::enable_if_t<!isExpression<Trigger>::value>, typename = void>
+Status exitStatus(const Trigger&, const D&, const Value&, const Y&, const S&, const L&) {
+    return Status::Completed;
+}
+
 // Construct an End Trigger Function from a Single Value
 template<typename Value>
 auto constructEndTrigger(Value v1) {
     return [=](auto /*dv*/, auto v, auto /*y*/, auto /*stats*/, auto limits) -> bool {
-        return v > (v1 - limits.min);
+        return v >= (v1 - limits.min);
     };
 }
 
@@ -52,7 +452,7 @@ auto constructEndTrigger(std::initializer_list<Value> vs) {
         v1 = *it;
     }
     return [=](auto /*dv*/, auto v, auto /*y*/, auto /*stats*/, auto limits) -> bool {
-        return v > (v1 - limits.min);
+        return v >= (v1 - limits.min);
     };
 }
 
@@ -71,4 +471,3 @@ Trigger constructEndTrigger(Trigger trig) {
 } /*namespace epode*/
 
 #endif // EPODE_TRIGGERS_H
-
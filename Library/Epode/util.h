@@ -38,7 +38,7 @@ inline Value lastInitElement(std::initializer_list<Value> _init) {
 
 template<typename Results>
 bool resultsToCSV(
-        const std::string& filename, Results results,
+        const std::string& filename, const Results& results,
         const std::string& header = std::string()
         ) {
     auto file = std::ofstream{};
@@ -47,9 +47,9 @@ bool resultsToCSV(
     if(file) {
         file << header << "\n";
 
-        for(auto result: results) {
-            using properties_t = decltype(internal::stateProperties(result.y));
-            constexpr size_t N = properties_t::N;
+        for(const auto& result: results) {
+            // The state size is taken at runtime so that dynamically sized states are supported
+            const auto N = static_cast<size_t>(result.y.size());
 
             file << result.dv << ", ";
             file << result.v << ", ";
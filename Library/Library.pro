@@ -14,18 +14,37 @@ HEADERS += \
     Epode/Kutta3rd \
     Epode/Kutta4th \
     Epode/RKF45 \
+    Epode/adams.h \
+    Epode/allocation.h \
+    Epode/autodiff.h \
+    Epode/batch.h \
+    Epode/bdf.h \
     Epode/butcher.h \
     Epode/core.h \
+    Epode/dense.h \
+    Epode/dormand_prince.h \
+    Epode/ensemble.h \
     Epode/euler.h \
+    Epode/events.h \
+    Epode/explicit_rk.h \
     Epode/bogacki_shampine.h \
+    Epode/implicit.h \
+    Epode/instrument.h \
     Epode/integrator.h \
+    Epode/nordsieck.h \
     Epode/ode.h \
+    Epode/output.h \
+    Epode/radau.h \
     Epode/solve.h \
+    Epode/sparse.h \
     Epode/step.h \
+    Epode/stepper.h \
+    Epode/trace.h \
     Epode/triggers.h \
     Epode/util.h \
     Epode/rk2.h \
-    Epode/rkf.h
+    Epode/rkf.h \
+    Epode/rosenbrock.h
 
 DISTFILES += \
     ../../Tests/C++/ODE_Integration/Epode/MPL_2_0.txt \